@@ -31,12 +31,20 @@ struct draculaView {
 	PlaceId trailLocations[TRAIL_SIZE - 1]; // Dracula's last 5 locations
 	                                        // in reverse order
 	int trailLength;
+	
+	// the same trail, for O(1) legality checks
+	PlaceSet trailPlaces;                   // the real places in trailMoves
+	bool trailHasHide;                      // if trailMoves contains HIDE
+	bool trailHasDoubleBack;                // ... or a DOUBLE_BACK
 };
 
 PlaceId DvWhereAmI(DraculaView dv);
 
 static void fillTrail(DraculaView dv);
 static bool canMoveTo(DraculaView dv, PlaceId location);
+static PlaceSet draculaReachable(DraculaView dv, int transportMask);
+static bool isDoubleBack(PlaceId move);
+static Round hunterNextRound(DraculaView dv, Player hunter);
 
 ////////////////////////////////////////////////////////////////////////
 // Constructor/Destructor
@@ -54,6 +62,12 @@ DraculaView DvNew(char *pastPlays, Message messages[])
 	return dv;
 }
 
+void DvUpdate(DraculaView dv, char *pastPlays)
+{
+	GvUpdate(dv->gv, pastPlays);
+	fillTrail(dv);
+}
+
 /**
  * For convenience, fills the trailMoves and trailLocations arrays in
  * the DraculaView struct with Dracula's last 5 moves/locations, and
@@ -82,6 +96,29 @@ static void fillTrail(DraculaView dv) {
 	dv->trailLength = numMoves;
 	if (canFreeMoves) free(moves);
 	if (canFreeLocations) free(locations);
+	
+	dv->trailPlaces = placeSetEmpty();
+	dv->trailHasHide = false;
+	dv->trailHasDoubleBack = false;
+	for (int i = 0; i < dv->trailLength; i++) {
+		PlaceId move = dv->trailMoves[i];
+		dv->trailPlaces = placeSetAdd(dv->trailPlaces, move);
+		if (move == HIDE) dv->trailHasHide = true;
+		if (isDoubleBack(move)) dv->trailHasDoubleBack = true;
+	}
+}
+
+DraculaView DvClone(DraculaView dv)
+{
+	DraculaView clone = malloc(sizeof(*clone));
+	if (clone == NULL) {
+		fprintf(stderr, "Couldn't allocate DraculaView\n");
+		exit(EXIT_FAILURE);
+	}
+
+	*clone = *dv;
+	clone->gv = GvClone(dv->gv);
+	return clone;
 }
 
 void DvFree(DraculaView dv)
@@ -137,7 +174,6 @@ static bool    trailContains(DraculaView dv, PlaceId move);
 PlaceId 	   resolveDoubleBack(DraculaView dv, PlaceId db);
 static bool    canReach(DraculaView dv, PlaceId location);
 static bool    trailContainsDoubleBack(DraculaView dv);
-static bool    isDoubleBack(PlaceId move);
 
 PlaceId *DvGetValidMoves(DraculaView dv, int *numReturnedMoves)
 {
@@ -150,31 +186,28 @@ PlaceId *DvGetValidMoves(DraculaView dv, int *numReturnedMoves)
 	// valid moves
 	PlaceId *moves = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
 	assert(moves != NULL);
-	
+	DvGetValidMovesInto(dv, moves, numReturnedMoves);
+	return moves;
+}
+
+void DvGetValidMovesInto(DraculaView dv, PlaceId moves[static NUM_REAL_PLACES],
+                         int *numReturnedMoves)
+{
 	*numReturnedMoves = 0;
+	if (DvWhereAmI(dv) == NOWHERE) return;
+	
 	addLocationMoves(dv, moves, numReturnedMoves);
 	addDoubleBackMoves(dv, moves, numReturnedMoves);
 	addHideMoves(dv, moves, numReturnedMoves);
-	return moves;
 }
 
 static void addLocationMoves(DraculaView dv, PlaceId *moves,
                              int *numReturnedMoves) {
-	// Get the locations that Dracula can reach (we pass 1 as the round
-	// number, since Dracula's movement doesn't depend on round number)
-	int numLocs = 0;
-	PlaceId *locs = GvGetReachable(dv->gv, PLAYER_DRACULA, 1,
-	                               DvWhereAmI(dv), &numLocs);
-	
-	// For each location, check if it's a legal move, and add it to the
-	// moves array if so
-	for (int i = 0; i < numLocs; i++) {
-		if (moveIsLegal(dv, locs[i])) {
-			moves[(*numReturnedMoves)++] = locs[i];
-		}
-	}
-	
-	free(locs);
+	// A location move is legal if Dracula can reach the location and
+	// it isn't already in his trail
+	PlaceSet legal = placeSetDifference(draculaReachable(dv, BY_ANY),
+	                                    dv->trailPlaces);
+	*numReturnedMoves += placeSetToPlaces(legal, &moves[*numReturnedMoves]);
 }
 
 static void addDoubleBackMoves(DraculaView dv, PlaceId *moves,
@@ -214,16 +247,22 @@ static bool moveIsLegal(DraculaView dv, PlaceId move) {
 }
 
 static bool trailContains(DraculaView dv, PlaceId move) {
-	return placesContains(dv->trailMoves, dv->trailLength, move);
+	if (move == HIDE) return dv->trailHasHide;
+	return placeSetContains(dv->trailPlaces, move);
 }
 
 static bool canReach(DraculaView dv, PlaceId location) {
-	int numLocs = 0;
-	PlaceId *places = GvGetReachable(dv->gv, PLAYER_DRACULA, 1,
-	                                 DvWhereAmI(dv), &numLocs);
-	bool result = placesContains(places, numLocs, location);
-	free(places);
-	return result;
+	return placeSetContains(draculaReachable(dv, BY_ANY), location);
+}
+
+/**
+ * Gets the locations Dracula could reach from where he is, ignoring his
+ * trail. (We pass 1 as the round number, since Dracula's movement
+ * doesn't depend on round number.)
+ */
+static PlaceSet draculaReachable(DraculaView dv, int transportMask) {
+	return GvReachableMask(dv->gv, PLAYER_DRACULA, 1, DvWhereAmI(dv),
+	                       transportMask & ~BY_RAIL);
 }
 
 /**
@@ -240,12 +279,7 @@ PlaceId resolveDoubleBack(DraculaView dv, PlaceId db) {
 }
 
 static bool trailContainsDoubleBack(DraculaView dv) {
-	for (int i = 0; i < dv->trailLength; i++) {
-		if (isDoubleBack(dv->trailMoves[i])) {
-			return true;
-		}
-	}
-	return false;
+	return dv->trailHasDoubleBack;
 }
 
 static bool isDoubleBack(PlaceId move) {
@@ -267,12 +301,32 @@ PlaceId *DvWhereCanIGoByType(DraculaView dv, bool road, bool boat,
 		return NULL;
 	}
 
+	PlaceId *reachable = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
+	assert(reachable != NULL);
+	DvWhereCanIGoByTypeInto(dv, road, boat, reachable, numReturnedLocs);
+	return reachable;
+}
+
+void DvWhereCanIGoInto(DraculaView dv, PlaceId locs[static NUM_REAL_PLACES],
+                       int *numReturnedLocs)
+{
+	DvWhereCanIGoByTypeInto(dv, true, true, locs, numReturnedLocs);
+}
+
+void DvWhereCanIGoByTypeInto(DraculaView dv, bool road, bool boat,
+                             PlaceId reachable[static NUM_REAL_PLACES],
+                             int *numReturnedLocs)
+{
+	if (DvWhereAmI(dv) == NOWHERE) {
+		*numReturnedLocs = 0;
+		return;
+	}
+
 	// Get an array of locations connected to Dracula's location
 	// by the given transport methods
 	int numReachable = 0;
-	PlaceId *reachable = GvGetReachableByType(dv->gv, PLAYER_DRACULA, 1,
-	                                          DvWhereAmI(dv), road, false,
-	                                          boat, &numReachable);
+	GvGetReachableByTypeInto(dv->gv, PLAYER_DRACULA, 1, DvWhereAmI(dv),
+	                         road, false, boat, reachable, &numReachable);
 	
 	// Remove all of those locations that Dracula can't move to
 	int i = 0;
@@ -287,7 +341,6 @@ PlaceId *DvWhereCanIGoByType(DraculaView dv, bool road, bool boat,
 	}
 	
 	*numReturnedLocs = numReachable;
-	return reachable;
 }
 
 /**
@@ -336,15 +389,101 @@ PlaceId *DvWhereCanTheyGoByType(DraculaView dv, Player player,
 	
 	if (player == PLAYER_DRACULA) {
 		return DvWhereCanIGoByType(dv, road, boat, numReturnedLocs);
+	}
+	
+	PlaceId *locs = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
+	assert(locs != NULL);
+	DvWhereCanTheyGoByTypeInto(dv, player, road, rail, boat, locs,
+	                           numReturnedLocs);
+	return locs;
+}
+
+void DvWhereCanTheyGoInto(DraculaView dv, Player player,
+                          PlaceId locs[static NUM_REAL_PLACES],
+                          int *numReturnedLocs)
+{
+	DvWhereCanTheyGoByTypeInto(dv, player, true, true, true, locs,
+	                           numReturnedLocs);
+}
+
+void DvWhereCanTheyGoByTypeInto(DraculaView dv, Player player,
+                                bool road, bool rail, bool boat,
+                                PlaceId locs[static NUM_REAL_PLACES],
+                                int *numReturnedLocs)
+{
+	if (DvGetPlayerLocation(dv, player) == NOWHERE) {
+		*numReturnedLocs = 0;
+		return;
+	}
+	
+	if (player == PLAYER_DRACULA) {
+		DvWhereCanIGoByTypeInto(dv, road, boat, locs, numReturnedLocs);
 	} else {
 		// The next move for all hunters is next round
 		Round round = GvGetRound(dv->gv) + 1;
-		return GvGetReachableByType(dv->gv, player, round,
-		                            GvGetPlayerLocation(dv->gv, player),
-		                            road, rail, boat, numReturnedLocs);
+		GvGetReachableByTypeInto(dv->gv, player, round,
+		                         GvGetPlayerLocation(dv->gv, player),
+		                         road, rail, boat, locs, numReturnedLocs);
 	}
 }
 
+PlaceSet DvReachableMask(DraculaView dv, Player player, int transportMask)
+{
+	if (DvGetPlayerLocation(dv, player) == NOWHERE) {
+		return placeSetEmpty();
+	}
+	
+	if (player != PLAYER_DRACULA) {
+		return GvReachableMask(dv->gv, player, hunterNextRound(dv, player),
+		                       GvGetPlayerLocation(dv->gv, player),
+		                       transportMask);
+	}
+	
+	// Places in the trail are only off limits once he has used his
+	// DOUBLE_BACK, and even then he can stay put by HIDing (see canMoveTo)
+	PlaceSet reachable = draculaReachable(dv, transportMask);
+	if (!dv->trailHasDoubleBack) {
+		return reachable;
+	}
+	PlaceSet blocked = dv->trailPlaces;
+	if (canMoveTo(dv, DvWhereAmI(dv))) {
+		blocked = placeSetRemove(blocked, DvWhereAmI(dv));
+	}
+	return placeSetDifference(reachable, blocked);
+}
+
+void DvGetHunterDistances(DraculaView dv, HunterDistances *hd)
+{
+	GvGetHunterDistances(dv->gv, hd);
+}
+
+PlaceId DvGetNextStep(DraculaView dv, Player hunter, PlaceId dest)
+{
+	PlaceId src = GvGetPlayerLocation(dv->gv, hunter);
+	int railPhase = (hunter + hunterNextRound(dv, hunter)) % 4;
+	return MapHunterNextStep(GvGetMap(dv->gv), src, dest, railPhase);
+}
+
+void DvApplyMove(DraculaView dv, Player player, PlaceId move, GvUndo *undo)
+{
+	GvApplyMove(dv->gv, player, move, NULL, undo);
+	if (player == PLAYER_DRACULA) fillTrail(dv);
+}
+
+void DvUndoMove(DraculaView dv, Player player, GvUndo *undo)
+{
+	GvUndoMove(dv->gv, undo);
+	if (player == PLAYER_DRACULA) fillTrail(dv);
+}
+
+/**
+ * Gets the round of the given hunter's next move. Outside of DvApplyMove
+ * it's always Dracula's turn, so this is the next round.
+ */
+static Round hunterNextRound(DraculaView dv, Player hunter) {
+	return GvGetRound(dv->gv) + (hunter < GvGetPlayer(dv->gv) ? 1 : 0);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
 
@@ -370,8 +509,9 @@ PlaceId *DvShortestPathTo(DraculaView dv, PlaceId src, PlaceId dest, int *pathLe
 	while (!(QueueIsEmpty(q1) && QueueIsEmpty(q2))) {
 		PlaceId curr = QueueDequeue(q1);
 		int numReachable = 0;
-		PlaceId *reachable = GvGetReachable(dv->gv, PLAYER_DRACULA, -1, curr,
-		                                    &numReachable);
+		PlaceId reachable[NUM_REAL_PLACES];
+		GvGetReachableInto(dv->gv, PLAYER_DRACULA, -1, curr, reachable,
+		                   &numReachable);
 		
 		for (int i = 0; i < numReachable; i++) {
 			if (pred[reachable[i]] == -1) {
@@ -379,7 +519,6 @@ PlaceId *DvShortestPathTo(DraculaView dv, PlaceId src, PlaceId dest, int *pathLe
 				QueueEnqueue(q2, reachable[i]);
 			}
 		}
-		free(reachable);
 		
 		// When we've exhausted the current round's locations, advance
 		// to the next round and swap the queues (so the next round's
@@ -418,3 +557,10 @@ PlaceId *DvGetReachable(DraculaView dv, Player player, Round round, PlaceId from
 {
 	return GvGetReachable(dv->gv, player, round, from, numReturnedLocs);
 }
+
+void DvGetReachableInto(DraculaView dv, Player player, Round round,
+                        PlaceId from, PlaceId locs[static NUM_REAL_PLACES],
+                        int *numReturnedLocs)
+{
+	GvGetReachableInto(dv->gv, player, round, from, locs, numReturnedLocs);
+}
@@ -20,6 +20,7 @@
 
 #include "Game.h"
 #include "Places.h"
+#include "GameView.h"
 
 typedef struct draculaView *DraculaView;
 
@@ -178,6 +179,74 @@ PlaceId *DvWhereCanTheyGoByType(DraculaView dv, Player player,
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
 
+/**
+ * Brings the given view up to date with `pastPlays`, a later pastPlays
+ * string from the same game (see GvUpdate). Usually only the new plays
+ * are processed, so one view can be kept for the whole game; if earlier
+ * plays were rewritten (when Dracula's moves are revealed), the view is
+ * worked out again from the whole string.
+ */
+void DvUpdate(DraculaView dv, char *pastPlays);
+
+/**
+ * Creates an independent copy of the given view (see GvClone). Free it
+ * with DvFree.
+ */
+DraculaView DvClone(DraculaView dv);
+
+/**
+ * The same as DvGetValidMoves, DvWhereCanIGo, DvWhereCanIGoByType,
+ * DvWhereCanTheyGo and DvWhereCanTheyGoByType, but the moves/locations
+ * are written to the given array (e.g. one on the caller's stack)
+ * instead of a newly allocated array. The count is set to 0 where those
+ * functions would return NULL.
+ */
+void DvGetValidMovesInto(DraculaView dv, PlaceId moves[static NUM_REAL_PLACES],
+                         int *numReturnedMoves);
+void DvWhereCanIGoInto(DraculaView dv, PlaceId locs[static NUM_REAL_PLACES],
+                       int *numReturnedLocs);
+void DvWhereCanIGoByTypeInto(DraculaView dv, bool road, bool boat,
+                             PlaceId locs[static NUM_REAL_PLACES],
+                             int *numReturnedLocs);
+void DvWhereCanTheyGoInto(DraculaView dv, Player player,
+                          PlaceId locs[static NUM_REAL_PLACES],
+                          int *numReturnedLocs);
+void DvWhereCanTheyGoByTypeInto(DraculaView dv, Player player,
+                                bool road, bool rail, bool boat,
+                                PlaceId locs[static NUM_REAL_PLACES],
+                                int *numReturnedLocs);
+
+/**
+ * Similar to DvWhereCanTheyGoByType, but returns the locations as a set
+ * (empty if the player hasn't moved yet), so nothing is allocated.
+ * `transportMask` is a combination of BY_ROAD, BY_RAIL and BY_BOAT (see
+ * GameView.h).
+ */
+PlaceSet DvReachableMask(DraculaView dv, Player player, int transportMask);
+
+/**
+ * Fills *hd with every hunter's distance to every place, and the
+ * closest hunter to each place (see GvGetHunterDistances). This is a
+ * handful of table copies, so a move can be scored with lookups.
+ */
+void DvGetHunterDistances(DraculaView dv, HunterDistances *hd);
+
+/**
+ * Gets the first move on a shortest path from the given hunter's current
+ * location to `dest` (their current location if they're already there).
+ */
+PlaceId DvGetNextStep(DraculaView dv, Player hunter, PlaceId dest);
+
+/**
+ * Makes a move for the given player (who must be the current player) on
+ * the view itself, for searching ahead: see GvApplyMove. Encounters are
+ * worked out as the game engine would. Every other function works on the
+ * resulting state, until the move is taken back with DvUndoMove (moves
+ * must be undone in reverse order, and before the view is updated).
+ */
+void DvApplyMove(DraculaView dv, Player player, PlaceId move, GvUndo *undo);
+void DvUndoMove(DraculaView dv, Player player, GvUndo *undo);
+
 // Retrieves location for DOUBLE_BACK move
 PlaceId resolveDoubleBack(DraculaView dv, PlaceId db);
 
@@ -186,5 +255,8 @@ PlaceId *DvShortestPathTo(DraculaView dv, PlaceId src, PlaceId dest, int *pathLe
 
 // Returns reachable locations
 PlaceId *DvGetReachable(DraculaView dv, Player player, Round round, PlaceId from, int *numReturnedLocs);
+void DvGetReachableInto(DraculaView dv, Player player, Round round,
+                        PlaceId from, PlaceId locs[static NUM_REAL_PLACES],
+                        int *numReturnedLocs);
 
 #endif // !defined(FOD__DRACULA_VIEW_H_)
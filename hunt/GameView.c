@@ -23,7 +23,9 @@
 #include "GameView.h"
 #include "Map.h"
 #include "Places.h"
+#include "Plays.h"
 // add your own #includes here
+#include "MapData.h"
 #include "utils.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -55,23 +57,20 @@ typedef struct turn {
 
 struct gameView {
 	// State
-	Round    round;                        // current round number
-	Player   currentPlayer;                // current player
-	int      score;                        // game score
-	int      playerHealth[NUM_PLAYERS];    // health of each player
-	PlaceId  playerLocations[NUM_PLAYERS]; // location of each player
-	PlaceId  trapLocations[TRAIL_SIZE];    // locations of traps
-	int      numActiveTraps;               // number of active traps
-	PlaceId  vampireLocation;              // location of the immature vampire
+	GameState state;                       // everything but the history
 	bool     restAttempted;                // if the hunter attempted to rest
+	int      numTurns;                     // number of plays processed
 	
 	// History
 	PlaceId *moveHistory[NUM_PLAYERS];     // each player's move history
 	PlaceId *draculaLocationHistory;       // Dracula's location history
+	int      historyCapacity;              // rounds the history can hold
 	
-	Map      map;
+	Map      map;                          // shared map (borrowed)
 };
 
+static_assert(sizeof(GameState) <= 64, "GameState should stay small");
+
 // Helper functions
 static int     max(int num1, int num2);
 static int     min(int num1, int num2);
@@ -79,16 +78,23 @@ static int     min(int num1, int num2);
 ////////////////////////////////////////////////////////////////////////
 // Constructor
 
-static Turn   *pastPlaysToTurns(char *pastPlays, int *numTurns);
 static int     pastPlaysToNumTurns(char *pastPlays);
 static Turn    playToTurn(char *play);
+static Turn    moveToTurn(Player player, PlaceId move, char *encounters);
+static Turn    encodedToTurn(Player player, PlaceId move, uint8_t encounters);
 
 static int     numTurnsToNumRounds(int numTurns);
 static void    initGameView(GameView gv, int numRounds);
-static void    processTurns(GameView gv, Turn *turn, int numTurns);
+static void    initState(GameView gv);
+static bool    sawPlays(GameView gv, char *pastPlays, int numTurns);
+static bool    sawTurns(GameView gv, TurnBuffer *buf);
+static void    growHistory(GameView gv);
+static void    processPlays(GameView gv, char *pastPlays, int numTurns);
+static void    processTurnBuffer(GameView gv, TurnBuffer *buf);
 static void    processTurn(GameView gv, Turn turn);
 
 static void    processDraculaTurn(GameView gv, Turn turn);
+static void    processDraculaTrailEnd(GameView gv, Turn turn);
 static void    processDraculaMove(GameView gv, Turn turn);
 static PlaceId resolveDraculaMove(GameView gv, PlaceId move);
 static void    processDraculaActions(GameView gv, Turn turn);
@@ -108,9 +114,26 @@ static void    processDraculaEncountered(GameView gv);
 static void    processHunterEndOfTurn(GameView gv);
 static void    processHunterLifeGain(GameView gv, Player hunter, int amount);
 
+static void    setLocation(GameView gv, Player player, PlaceId location);
+static void    setHealth(GameView gv, Player player, int health);
+static void    setVampire(GameView gv, PlaceId location);
+static void    hashTraps(GameView gv, PlaceId location, int change);
+static void    hashTrail(GameView gv);
+static void    hashTurn(GameView gv);
+static uint64_t stateHash(GameState *s);
+
+static bool    trapAt(GameView gv, PlaceId location);
 static void    processRemoveTrap(GameView gv, PlaceId location);
 static void    processPlayerDamage(GameView gv, Player player, int damage);
 
+static void    deriveEncounters(GameView gv, Player player, PlaceId move,
+                                char encounters[4]);
+static void    deriveDraculaEncounters(GameView gv, PlaceId move,
+                                       char encounters[4]);
+static void    deriveHunterEncounters(GameView gv, Player hunter,
+                                      PlaceId move, char encounters[4]);
+static int     numEncountersAt(GameView gv, PlaceId location);
+
 GameView GvNew(char *pastPlays, Message messages[])
 {
 	GameView gv = malloc(sizeof(*gv));
@@ -119,34 +142,35 @@ GameView GvNew(char *pastPlays, Message messages[])
 		exit(EXIT_FAILURE);
 	}
 	
-	int numTurns = 0;
-	Turn *turns = pastPlaysToTurns(pastPlays, &numTurns);
-	
+	int numTurns = pastPlaysToNumTurns(pastPlays);
 	int numRounds = numTurnsToNumRounds(numTurns);
 	initGameView(gv, numRounds);
-	processTurns(gv, turns, numTurns);
-	free(turns);
 	
-	gv->map = MapNew();
+	processPlays(gv, pastPlays, numTurns);
+	
+	gv->map = MapNew(); // the shared map - never built or freed
 	return gv;
 }
 
 /**
- * Converts a pastPlays string to an array of Turn structs, and sets
- * *numTurns to the number of turns
+ * Processes the plays in a pastPlays string, from the first play that
+ * the GameView hasn't seen yet up to (but not including) play numTurns
  */
-static Turn *pastPlaysToTurns(char *pastPlays, int *numTurns) {
-	*numTurns = pastPlaysToNumTurns(pastPlays);
-	Turn *turns = malloc(*numTurns * sizeof(Turn));
-	if (turns == NULL) {
-		fprintf(stderr, "Insufficient memory!\n");
-		exit(EXIT_FAILURE);
-	}
-	for (int i = 0; i < *numTurns; i++) {
+static void processPlays(GameView gv, char *pastPlays, int numTurns) {
+	for (int i = gv->numTurns; i < numTurns; i++) {
 		// Hack to avoid string splitting
-		turns[i] = playToTurn(&pastPlays[i * 8]);
+		processTurn(gv, playToTurn(&pastPlays[i * 8]));
+	}
+}
+
+/**
+ * Processes the plays in a TurnBuffer that the GameView hasn't seen yet
+ */
+static void processTurnBuffer(GameView gv, TurnBuffer *buf) {
+	for (int i = gv->numTurns; i < buf->numTurns; i++) {
+		processTurn(gv, encodedToTurn(buf->players[i], buf->moves[i],
+		                              buf->encounters[i]));
 	}
-	return turns;
 }
 
 /**
@@ -173,32 +197,47 @@ static int pastPlaysToNumTurns(char *pastPlays) {
  * Converts a play string to a Turn struct
  */
 static Turn playToTurn(char *play) {
-	Turn turn = {};
+	Player player = PLAYER_LORD_GODALMING;
 	
 	switch (play[0]) {
-		case 'G': turn.player = PLAYER_LORD_GODALMING; break;
-		case 'S': turn.player = PLAYER_DR_SEWARD;      break;
-		case 'H': turn.player = PLAYER_VAN_HELSING;    break;
-		case 'M': turn.player = PLAYER_MINA_HARKER;    break;
-		case 'D': turn.player = PLAYER_DRACULA;        break;
-		default:  assert(0); /* impossible */          break;
+		case 'G': player = PLAYER_LORD_GODALMING; break;
+		case 'S': player = PLAYER_DR_SEWARD;      break;
+		case 'H': player = PLAYER_VAN_HELSING;    break;
+		case 'M': player = PLAYER_MINA_HARKER;    break;
+		case 'D': player = PLAYER_DRACULA;        break;
+		default:  assert(0); /* impossible */     break;
 	}
 	
-	turn.move = placeAbbrevToId((char[3]){ play[1], play[2], '\0' });
+	PlaceId move = mapAbbrevToId(&play[1]);
+	return moveToTurn(player, move, &play[3]);
+}
+
+/**
+ * Converts a move and the encounter characters of a play (the four
+ * characters after the location) to a Turn struct
+ */
+static Turn moveToTurn(Player player, PlaceId move, char *encounters) {
+	return encodedToTurn(player, move, playEncodeEncounters(encounters));
+}
+
+static Turn encodedToTurn(Player player, PlaceId move, uint8_t encounters) {
+	Turn turn = {};
+	turn.player = player;
+	turn.move = move;
 	
 	if (turn.player == PLAYER_DRACULA) {
-		if (play[5] == 'V') turn.actions[turn.numActions++] = VAMPIRE_MATURED;
-		if (play[5] == 'M') turn.actions[turn.numActions++] = TRAP_MALFUNCTIONED;
-		if (play[4] == 'V') turn.actions[turn.numActions++] = PLACED_VAMPIRE;
-		if (play[3] == 'T') turn.actions[turn.numActions++] = PLACED_TRAP;
+		EncounterCode end = playEncounter(encounters, 2);
+		if (end == ENCOUNTER_VAMPIRE) turn.actions[turn.numActions++] = VAMPIRE_MATURED;
+		if (end == ENCOUNTER_OTHER)   turn.actions[turn.numActions++] = TRAP_MALFUNCTIONED;
+		if (playEncounter(encounters, 1) == ENCOUNTER_VAMPIRE) turn.actions[turn.numActions++] = PLACED_VAMPIRE;
+		if (playEncounter(encounters, 0) == ENCOUNTER_TRAP)    turn.actions[turn.numActions++] = PLACED_TRAP;
 	} else {
-		for (int i = 3; i < 7; i++) {
-			switch (play[i]) {
-				case 'T': turn.actions[turn.numActions++] = ENCOUNTERED_TRAP;    break;
-				case 'V': turn.actions[turn.numActions++] = ENCOUNTERED_VAMPIRE; break;
-				case 'D': turn.actions[turn.numActions++] = ENCOUNTERED_DRACULA; break;
-				case '.':                                                        break;
-				default:  assert(0); /* impossible */                            break;
+		for (int i = 0; i < PLAY_NUM_ENCOUNTERS; i++) {
+			switch (playEncounter(encounters, i)) {
+				case ENCOUNTER_TRAP:    turn.actions[turn.numActions++] = ENCOUNTERED_TRAP;    break;
+				case ENCOUNTER_VAMPIRE: turn.actions[turn.numActions++] = ENCOUNTERED_VAMPIRE; break;
+				case ENCOUNTER_OTHER:   turn.actions[turn.numActions++] = ENCOUNTERED_DRACULA; break;
+				case ENCOUNTER_NONE:                                                           break;
 			}
 		}
 	}
@@ -219,53 +258,79 @@ static int numTurnsToNumRounds(int numTurns) {
  * Initialises the given GameView struct with the given number of rounds
  */
 static void initGameView(GameView gv, int numRounds) {
-	// State
-	gv->round = 0;
-	gv->currentPlayer = PLAYER_LORD_GODALMING;
-	gv->score = GAME_START_SCORE;
+	initState(gv);
 	
+	// History (this grows if more plays are appended later)
+	gv->historyCapacity = max(numRounds, 1);
 	for (int i = 0; i < NUM_PLAYERS; i++) {
-		gv->playerHealth[i] = (i == PLAYER_DRACULA) ?
-			GAME_START_BLOOD_POINTS : GAME_START_HUNTER_LIFE_POINTS;
-		gv->playerLocations[i] = NOWHERE;
+		gv->moveHistory[i] = malloc(gv->historyCapacity * sizeof(PlaceId));
 	}
+	gv->draculaLocationHistory = malloc(gv->historyCapacity * sizeof(PlaceId));
+}
+
+/**
+ * Puts the given GameView back at the start of the game, keeping the
+ * history arrays (which are overwritten as plays are processed)
+ */
+static void initState(GameView gv) {
+	gv->state.round = 0;
+	gv->state.player = PLAYER_LORD_GODALMING;
+	gv->state.score = GAME_START_SCORE;
 	
-	gv->numActiveTraps = 0;
-	gv->vampireLocation = NOWHERE;
-	gv->restAttempted = false;
-	
-	// History
 	for (int i = 0; i < NUM_PLAYERS; i++) {
-		gv->moveHistory[i] = malloc(numRounds * sizeof(PlaceId));
+		gv->state.health[i] = (i == PLAYER_DRACULA) ?
+			GAME_START_BLOOD_POINTS : GAME_START_HUNTER_LIFE_POINTS;
+		gv->state.location[i] = NOWHERE;
 	}
-	gv->draculaLocationHistory = malloc(numRounds * sizeof(PlaceId));
+	
+	gv->state.trailLength = 0;
+	gv->state.numTraps = 0;
+	gv->state.vampire = NOWHERE;
+	gv->state.hash = stateHash(&gv->state);
+	gv->restAttempted = false;
+	gv->numTurns = 0;
 }
 
-static void processTurns(GameView gv, Turn *turns, int numTurns) {
-	for (int i = 0; i < numTurns; i++) {
-		processTurn(gv, turns[i]);
+/**
+ * Doubles the number of rounds that the history arrays can hold
+ */
+static void growHistory(GameView gv) {
+	gv->historyCapacity *= 2;
+	size_t size = gv->historyCapacity * sizeof(PlaceId);
+	for (int i = 0; i < NUM_PLAYERS; i++) {
+		gv->moveHistory[i] = realloc(gv->moveHistory[i], size);
+		assert(gv->moveHistory[i] != NULL);
 	}
+	gv->draculaLocationHistory = realloc(gv->draculaLocationHistory, size);
+	assert(gv->draculaLocationHistory != NULL);
 }
 
 /**
  * Processes a turn
  */
 static void processTurn(GameView gv, Turn turn) {
-	assert(gv->currentPlayer == turn.player);
+	assert(gv->state.player == turn.player);
+	
+	if (gv->state.round >= gv->historyCapacity) {
+		growHistory(gv);
+	}
+	gv->numTurns++;
 	
-	if (gv->currentPlayer == PLAYER_DRACULA) {
+	hashTurn(gv); // hash out the old player and round
+	if (gv->state.player == PLAYER_DRACULA) {
 		processDraculaTurn(gv, turn);
-		gv->round++; // Advance round after Dracula's turn
+		gv->state.round++; // Advance round after Dracula's turn
 	} else {
 		processHunterTurn(gv, turn);
 	}
 	
 	// Passes the turn to the next player
-	gv->currentPlayer = (gv->currentPlayer + 1) % NUM_PLAYERS;
+	gv->state.player = (gv->state.player + 1) % NUM_PLAYERS;
+	hashTurn(gv);
 	
 	// Revives the next player
-	if (gv->playerHealth[gv->currentPlayer] == 0) {
-		gv->playerHealth[gv->currentPlayer] = GAME_START_HUNTER_LIFE_POINTS;
+	if (gv->state.health[gv->state.player] == 0) {
+		setHealth(gv, gv->state.player, GAME_START_HUNTER_LIFE_POINTS);
 	}
 }
 
@@ -276,21 +341,49 @@ static void processTurn(GameView gv, Turn turn) {
  * Processes Dracula's turn
  */
 static void processDraculaTurn(GameView gv, Turn turn) {
+	processDraculaTrailEnd(gv, turn);
 	processDraculaMove(gv, turn);
 	processDraculaActions(gv, turn);
 	processDraculaEndOfTurn(gv);
 }
 
+/**
+ * Processes the encounter leaving the end of the trail. This is done
+ * before the move, while the oldest trail entry is still in the trail.
+ */
+static void processDraculaTrailEnd(GameView gv, Turn turn) {
+	for (int i = 0; i < turn.numActions; i++) {
+		switch (turn.actions[i]) {
+			case TRAP_MALFUNCTIONED: processMalfunctionedTrap(gv); break;
+			case VAMPIRE_MATURED:    processMaturedVampire(gv);    break;
+			default:                                               break;
+		}
+	}
+}
+
 static void processDraculaMove(GameView gv, Turn turn) {
 	// Store the move in the move history
-	gv->moveHistory[PLAYER_DRACULA][gv->round] = turn.move;
+	gv->moveHistory[PLAYER_DRACULA][gv->state.round] = turn.move;
 	
 	// Resolve the move to a location, in case it was a special move
 	// and update Dracula's location
-	gv->playerLocations[PLAYER_DRACULA] = resolveDraculaMove(gv, turn.move);
+	PlaceId location = resolveDraculaMove(gv, turn.move);
+	setLocation(gv, PLAYER_DRACULA, location);
 	
 	// Store the location in the location history
-	gv->draculaLocationHistory[gv->round] = gv->playerLocations[PLAYER_DRACULA];
+	gv->draculaLocationHistory[gv->state.round] = location;
+	
+	// Push the move onto the front of the trail
+	GameState *s = &gv->state;
+	hashTrail(gv);
+	if (s->trailLength < TRAIL_SIZE) s->trailLength++;
+	for (int i = s->trailLength - 1; i > 0; i--) {
+		s->trailMoves[i] = s->trailMoves[i - 1];
+		s->trailLocations[i] = s->trailLocations[i - 1];
+	}
+	s->trailMoves[0] = turn.move;
+	s->trailLocations[0] = location;
+	hashTrail(gv);
 }
 
 static PlaceId resolveDraculaMove(GameView gv, PlaceId move) {
@@ -300,12 +393,12 @@ static PlaceId resolveDraculaMove(GameView gv, PlaceId move) {
 	
 	switch (move) {
 		case TELEPORT:      return CASTLE_DRACULA;
-		case HIDE:          return gv->draculaLocationHistory[gv->round - 1];
-		case DOUBLE_BACK_1: return gv->draculaLocationHistory[gv->round - 1];
-		case DOUBLE_BACK_2: return gv->draculaLocationHistory[gv->round - 2];
-		case DOUBLE_BACK_3: return gv->draculaLocationHistory[gv->round - 3];
-		case DOUBLE_BACK_4: return gv->draculaLocationHistory[gv->round - 4];
-		case DOUBLE_BACK_5: return gv->draculaLocationHistory[gv->round - 5];
+		case HIDE:          return gv->state.trailLocations[0];
+		case DOUBLE_BACK_1: return gv->state.trailLocations[0];
+		case DOUBLE_BACK_2: return gv->state.trailLocations[1];
+		case DOUBLE_BACK_3: return gv->state.trailLocations[2];
+		case DOUBLE_BACK_4: return gv->state.trailLocations[3];
+		case DOUBLE_BACK_5: return gv->state.trailLocations[4];
 		default:            assert(0); // impossible
 	}
 }
@@ -315,8 +408,6 @@ static void processDraculaActions(GameView gv, Turn turn) {
 		switch (turn.actions[i]) {
 			case PLACED_TRAP:        processTrapPlaced(gv);        break;
 			case PLACED_VAMPIRE:     processVampirePlaced(gv);     break;
-			case TRAP_MALFUNCTIONED: processMalfunctionedTrap(gv); break;
-			case VAMPIRE_MATURED:    processMaturedVampire(gv);    break;
 			default:                                               break;
 		}
 	}
@@ -326,43 +417,45 @@ static void processDraculaActions(GameView gv, Turn turn) {
  * Dracula placed a trap
  */
 static void processTrapPlaced(GameView gv) {
-	gv->trapLocations[gv->numActiveTraps++] = gv->playerLocations[PLAYER_DRACULA];
+	PlaceId location = gv->state.location[PLAYER_DRACULA];
+	hashTraps(gv, location, +1);
+	gv->state.traps[gv->state.numTraps++] = location;
 }
 
 /**
  * Dracula placed a vampire
  */
 static void processVampirePlaced(GameView gv) {
-	gv->vampireLocation = gv->playerLocations[PLAYER_DRACULA];
+	setVampire(gv, gv->state.location[PLAYER_DRACULA]);
 }
 
 /**
  * A trap (from 6 rounds ago) malfunctioned
  */
 static void processMalfunctionedTrap(GameView gv) {
-	processRemoveTrap(gv, gv->draculaLocationHistory[gv->round - TRAIL_SIZE]);
+	processRemoveTrap(gv, gv->state.trailLocations[TRAIL_SIZE - 1]);
 }
 
 /**
  * A vampire matured
  */
 static void processMaturedVampire(GameView gv) {
-	gv->vampireLocation = NOWHERE;
-	gv->score -= SCORE_LOSS_VAMPIRE_MATURES;
+	setVampire(gv, NOWHERE);
+	gv->state.score -= SCORE_LOSS_VAMPIRE_MATURES;
 }
 
 static void processDraculaEndOfTurn(GameView gv) {
-	if (placeIsSea(gv->playerLocations[PLAYER_DRACULA])) {
+	if (placeIsSea(gv->state.location[PLAYER_DRACULA])) {
 		processPlayerDamage(gv, PLAYER_DRACULA, LIFE_LOSS_SEA);
 	}
-	if (gv->playerLocations[PLAYER_DRACULA] == CASTLE_DRACULA) {
+	if (gv->state.location[PLAYER_DRACULA] == CASTLE_DRACULA) {
 		processDraculaLifeGain(gv, LIFE_GAIN_CASTLE_DRACULA);
 	}
-	gv->score -= SCORE_LOSS_DRACULA_TURN;
+	gv->state.score -= SCORE_LOSS_DRACULA_TURN;
 }
 
 static void processDraculaLifeGain(GameView gv, int amount) {
-	gv->playerHealth[PLAYER_DRACULA] += amount;
+	setHealth(gv, PLAYER_DRACULA, gv->state.health[PLAYER_DRACULA] + amount);
 }
 
 ///////////////////
@@ -382,13 +475,13 @@ static void processHunterTurn(GameView gv, Turn turn) {
  */
 static void processHunterMove(GameView gv, Turn turn) {
 	// Store the move in the move history
-	gv->moveHistory[gv->currentPlayer][gv->round] = turn.move;
+	gv->moveHistory[gv->state.player][gv->state.round] = turn.move;
 	
 	// Check if the hunter is attempting to rest
-	gv->restAttempted = (turn.move == gv->playerLocations[gv->currentPlayer]);
+	gv->restAttempted = (turn.move == gv->state.location[gv->state.player]);
 	
 	// Update the hunter's location
-	gv->playerLocations[gv->currentPlayer] = turn.move;
+	setLocation(gv, gv->state.player, turn.move);
 }
 
 /**
@@ -405,9 +498,9 @@ static void processHunterActions(GameView gv, Turn turn) {
 	}
 	
 	// If the hunter died :(
-	if (gv->playerHealth[gv->currentPlayer] == 0) {
-		gv->playerLocations[gv->currentPlayer] = ST_JOSEPH_AND_ST_MARY;
-		gv->score -= SCORE_LOSS_HUNTER_HOSPITAL;
+	if (gv->state.health[gv->state.player] == 0) {
+		setLocation(gv, gv->state.player, ST_JOSEPH_AND_ST_MARY);
+		gv->state.score -= SCORE_LOSS_HUNTER_HOSPITAL;
 	}
 }
 
@@ -415,29 +508,29 @@ static void processHunterActions(GameView gv, Turn turn) {
  * The current player encounters a trap
  */
 static void processTrapEncountered(GameView gv) {
-	processPlayerDamage(gv, gv->currentPlayer, LIFE_LOSS_TRAP_ENCOUNTER);
-	processRemoveTrap(gv, gv->playerLocations[gv->currentPlayer]);
+	processPlayerDamage(gv, gv->state.player, LIFE_LOSS_TRAP_ENCOUNTER);
+	processRemoveTrap(gv, gv->state.location[gv->state.player]);
 }
 
 /**
  * The current player encounters an immature vampire
  */
 static void processVampireEncountered(GameView gv) {
-	gv->vampireLocation = NOWHERE;
+	setVampire(gv, NOWHERE);
 }
 
 /**
  * The current player encounters Dracula
  */
 static void processDraculaEncountered(GameView gv) {
-	processPlayerDamage(gv, gv->currentPlayer, LIFE_LOSS_DRACULA_ENCOUNTER);
+	processPlayerDamage(gv, gv->state.player, LIFE_LOSS_DRACULA_ENCOUNTER);
 	processPlayerDamage(gv, PLAYER_DRACULA, LIFE_LOSS_HUNTER_ENCOUNTER);
 }
 
 static void processHunterEndOfTurn(GameView gv) {
 	// If the player attempted to rest and is not dead, heal them
-	if (gv->playerHealth[gv->currentPlayer] > 0 && gv->restAttempted) {
-		processHunterLifeGain(gv, gv->currentPlayer, LIFE_GAIN_REST);
+	if (gv->state.health[gv->state.player] > 0 && gv->restAttempted) {
+		processHunterLifeGain(gv, gv->state.player, LIFE_GAIN_REST);
 	}
 }
 
@@ -445,26 +538,248 @@ static void processHunterEndOfTurn(GameView gv) {
  * The given hunter gains some life points
  */
 static void processHunterLifeGain(GameView gv, Player hunter, int amount) {
-	gv->playerHealth[hunter] = min(gv->playerHealth[hunter] + amount,
-	                               GAME_START_HUNTER_LIFE_POINTS);
+	setHealth(gv, hunter, min(gv->state.health[hunter] + amount,
+	                          GAME_START_HUNTER_LIFE_POINTS));
 }
 
 /////////////////////
 // Everyone's turns
 
 /**
- * Removes a trap from the given location
+ * Removes a trap from the given location. A hunter's play string may
+ * hide where Dracula put it, so if there's no trap known to be there,
+ * one placed in an unknown city is removed instead.
  */
 static void processRemoveTrap(GameView gv, PlaceId location) {
-	placesDelete(gv->trapLocations, gv->numActiveTraps, location);
-	gv->numActiveTraps--;
+	GameState *s = &gv->state;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < s->numTraps; i++) {
+			if (s->traps[i] == location) {
+				hashTraps(gv, location, -1);
+				s->traps[i] = s->traps[--s->numTraps];
+				return;
+			}
+		}
+		location = CITY_UNKNOWN;
+	}
+}
+
+/**
+ * Is there at least one trap at the given location?
+ */
+static bool trapAt(GameView gv, PlaceId location) {
+	for (int i = 0; i < gv->state.numTraps; i++) {
+		if (gv->state.traps[i] == location) return true;
+	}
+	return false;
 }
 
 /**
  * Deals a given amount of damage to the given player
  */
 static void processPlayerDamage(GameView gv, Player player, int amount) {
-	gv->playerHealth[player] = max(0, gv->playerHealth[player] - amount);
+	setHealth(gv, player, max(0, gv->state.health[player] - amount));
+}
+
+/////////////////////
+// Hashing
+//
+// Everything that changes the hashed parts of the state goes through
+// these, so gv->state.hash is always the same as stateHash(&gv->state)
+
+static void setLocation(GameView gv, Player player, PlaceId location) {
+	GameState *s = &gv->state;
+	s->hash ^= ZOBRIST_LOCATION[player][ZOBRIST_ID(s->location[player])] ^
+	           ZOBRIST_LOCATION[player][ZOBRIST_ID(location)];
+	s->location[player] = location;
+}
+
+static void setHealth(GameView gv, Player player, int health) {
+	GameState *s = &gv->state;
+	s->hash ^= ZOBRIST_HEALTH[player][ZOBRIST_HEALTH_ID(s->health[player])] ^
+	           ZOBRIST_HEALTH[player][ZOBRIST_HEALTH_ID(health)];
+	s->health[player] = health;
+}
+
+static void setVampire(GameView gv, PlaceId location) {
+	GameState *s = &gv->state;
+	s->hash ^= ZOBRIST_VAMPIRE[ZOBRIST_ID(s->vampire)] ^
+	           ZOBRIST_VAMPIRE[ZOBRIST_ID(location)];
+	s->vampire = location;
+}
+
+/**
+ * Updates the hash for the number of traps at the given location going
+ * up or down by one (call this before changing the traps)
+ */
+static void hashTraps(GameView gv, PlaceId location, int change) {
+	GameState *s = &gv->state;
+	int numTraps = 0;
+	for (int i = 0; i < s->numTraps; i++) {
+		if (s->traps[i] == location) numTraps++;
+	}
+	s->hash ^= ZOBRIST_TRAPS[numTraps][ZOBRIST_ID(location)] ^
+	           ZOBRIST_TRAPS[numTraps + change][ZOBRIST_ID(location)];
+}
+
+/**
+ * XORs the trail into (or out of) the hash
+ */
+static void hashTrail(GameView gv) {
+	GameState *s = &gv->state;
+	for (int i = 0; i < s->trailLength; i++) {
+		s->hash ^= ZOBRIST_TRAIL_MOVE[i][ZOBRIST_ID(s->trailMoves[i])] ^
+		           ZOBRIST_TRAIL_LOCATION[i][ZOBRIST_ID(s->trailLocations[i])];
+	}
+}
+
+/**
+ * XORs the current player and round into (or out of) the hash
+ */
+static void hashTurn(GameView gv) {
+	GameState *s = &gv->state;
+	s->hash ^= ZOBRIST_PLAYER[s->player] ^
+	           ZOBRIST_ROUND[ZOBRIST_ROUND_ID(s->round)];
+}
+
+/**
+ * Computes the hash of a state from scratch
+ */
+static uint64_t stateHash(GameState *s) {
+	uint64_t hash = ZOBRIST_PLAYER[s->player] ^
+	                ZOBRIST_ROUND[ZOBRIST_ROUND_ID(s->round)] ^
+	                ZOBRIST_VAMPIRE[ZOBRIST_ID(s->vampire)];
+	for (int i = 0; i < NUM_PLAYERS; i++) {
+		hash ^= ZOBRIST_LOCATION[i][ZOBRIST_ID(s->location[i])] ^
+		        ZOBRIST_HEALTH[i][ZOBRIST_HEALTH_ID(s->health[i])];
+	}
+	for (int i = 0; i < s->trailLength; i++) {
+		hash ^= ZOBRIST_TRAIL_MOVE[i][ZOBRIST_ID(s->trailMoves[i])] ^
+		        ZOBRIST_TRAIL_LOCATION[i][ZOBRIST_ID(s->trailLocations[i])];
+	}
+	
+	// Each location with traps contributes one key for its trap count
+	bool seen[ZOBRIST_NUM_IDS] = {};
+	for (int i = 0; i < s->numTraps; i++) {
+		int id = ZOBRIST_ID(s->traps[i]);
+		if (seen[id]) continue;
+		seen[id] = true;
+		int numTraps = 0;
+		for (int j = i; j < s->numTraps; j++) {
+			if (s->traps[j] == s->traps[i]) numTraps++;
+		}
+		hash ^= ZOBRIST_TRAPS[numTraps][id];
+	}
+	return hash;
+}
+
+/////////////////////
+// Deriving encounters
+
+/**
+ * Works out the encounter characters of a play (as they would appear in
+ * the play string) for the given player making the given move now
+ */
+static void deriveEncounters(GameView gv, Player player, PlaceId move,
+                             char encounters[4]) {
+	for (int i = 0; i < 4; i++) {
+		encounters[i] = '.';
+	}
+	
+	if (player == PLAYER_DRACULA) {
+		deriveDraculaEncounters(gv, move, encounters);
+	} else {
+		deriveHunterEncounters(gv, player, move, encounters);
+	}
+}
+
+/**
+ * Dracula places a vampire (in rounds divisible by 13) or a trap in each
+ * city he visits, unless it already holds 3 encounters. The encounter
+ * placed 6 rounds ago leaves the trail: a vampire that is still there
+ * matures, and a trap that is still there malfunctions.
+ */
+static void deriveDraculaEncounters(GameView gv, PlaceId move,
+                                    char encounters[4]) {
+	Round round = gv->state.round;
+	PlaceId location = resolveDraculaMove(gv, move);
+	int numEncounters = numEncountersAt(gv, location);
+	
+	if (gv->state.trailLength == TRAIL_SIZE) {
+		Round oldRound = round - TRAIL_SIZE;
+		PlaceId oldLocation = gv->state.trailLocations[TRAIL_SIZE - 1];
+		if (oldRound % 13 == 0) {
+			if (gv->state.vampire != NOWHERE) {
+				encounters[2] = 'V';
+			}
+		} else if (trapAt(gv, oldLocation)) {
+			// We can't tell traps in the same city apart, so assume
+			// it's the one from 6 rounds ago
+			encounters[2] = 'M';
+			if (oldLocation == location) numEncounters--;
+		}
+	}
+	
+	if (placeIsLand(location) && numEncounters < 3) {
+		if (round % 13 == 0) {
+			encounters[1] = 'V';
+		} else {
+			encounters[0] = 'T';
+		}
+	}
+}
+
+/**
+ * A hunter encounters every trap at their destination, then the
+ * immature vampire, then Dracula - unless they die on the way
+ */
+static void deriveHunterEncounters(GameView gv, Player hunter,
+                                   PlaceId move, char encounters[4]) {
+	int health = gv->state.health[hunter];
+	int i = 0;
+	
+	for (int j = 0; j < gv->state.numTraps && health > 0; j++) {
+		if (gv->state.traps[j] == move) {
+			encounters[i++] = 'T';
+			health -= LIFE_LOSS_TRAP_ENCOUNTER;
+		}
+	}
+	if (gv->state.vampire == move && health > 0) {
+		encounters[i++] = 'V';
+	}
+	if (gv->state.location[PLAYER_DRACULA] == move && health > 0) {
+		encounters[i++] = 'D';
+	}
+}
+
+/**
+ * Counts the traps and immature vampires at the given location
+ */
+static int numEncountersAt(GameView gv, PlaceId location) {
+	int numEncounters = (gv->state.vampire == location ? 1 : 0);
+	for (int i = 0; i < gv->state.numTraps; i++) {
+		if (gv->state.traps[i] == location) numEncounters++;
+	}
+	return numEncounters;
+}
+
+GameView GvClone(GameView gv)
+{
+	GameView clone = malloc(sizeof(*clone));
+	if (clone == NULL) {
+		fprintf(stderr, "Couldn't allocate GameView!\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	*clone = *gv;
+	size_t size = gv->historyCapacity * sizeof(PlaceId);
+	for (int i = 0; i < NUM_PLAYERS; i++) {
+		clone->moveHistory[i] = malloc(size);
+		memcpy(clone->moveHistory[i], gv->moveHistory[i], size);
+	}
+	clone->draculaLocationHistory = malloc(size);
+	memcpy(clone->draculaLocationHistory, gv->draculaLocationHistory, size);
+	return clone;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -475,7 +790,6 @@ void GvFree(GameView gv)
 		free(gv->moveHistory[i]);
 	}
 	free(gv->draculaLocationHistory);
-	MapFree(gv->map);
 	free(gv);
 }
 
@@ -484,40 +798,42 @@ void GvFree(GameView gv)
 
 Round GvGetRound(GameView gv)
 {
-	return gv->round;
+	return gv->state.round;
 }
 
 Player GvGetPlayer(GameView gv)
 {
-	return gv->currentPlayer;
+	return gv->state.player;
 }
 
 int GvGetScore(GameView gv)
 {
-	return gv->score;
+	return gv->state.score;
 }
 
 int GvGetHealth(GameView gv, Player player)
 {
-	return gv->playerHealth[player];
+	return gv->state.health[player];
 }
 
 PlaceId GvGetPlayerLocation(GameView gv, Player player)
 {
-	return gv->playerLocations[player];
+	return gv->state.location[player];
 }
 
 PlaceId GvGetVampireLocation(GameView gv)
 {
-	return gv->vampireLocation;
+	return gv->state.vampire;
 }
 
 PlaceId *GvGetTrapLocations(GameView gv, int *numTraps)
 {
-	// This just copies gv->trapLocations
-	*numTraps = gv->numActiveTraps;
+	// This just copies gv->state.traps
+	*numTraps = gv->state.numTraps;
 	PlaceId *trapLocations = malloc(*numTraps * sizeof(PlaceId));
-	placesCopy(trapLocations, gv->trapLocations, *numTraps);
+	for (int i = 0; i < *numTraps; i++) {
+		trapLocations[i] = gv->state.traps[i];
+	}
 	return trapLocations;
 }
 
@@ -529,7 +845,7 @@ PlaceId *GvGetMoveHistory(GameView gv, Player player,
 {
 	// 1 move for each previous round
 	// plus 1 move if they have made a move this round
-	*numReturnedMoves = gv->round + (player < gv->currentPlayer ? 1 : 0);
+	*numReturnedMoves = gv->state.round + (player < gv->state.player ? 1 : 0);
 	*canFree = false;
 	return gv->moveHistory[player];
 }
@@ -538,7 +854,7 @@ PlaceId *GvGetLastMoves(GameView gv, Player player, int numMoves,
                         int *numReturnedMoves, bool *canFree)
 {
 	// Get the number of moves the player has made
-	int numMovesMade =  gv->round + (player < gv->currentPlayer ? 1 : 0);
+	int numMovesMade =  gv->state.round + (player < gv->state.player ? 1 : 0);
 	
 	// If the number of moves requested is more than the number of
 	// moves the player has made, return only that many moves
@@ -558,7 +874,7 @@ PlaceId *GvGetLocationHistory(GameView gv, Player player,
 		
 	} else {
 		// 1 location for each previous round
-		*numReturnedLocs = gv->round;
+		*numReturnedLocs = gv->state.round;
 		*canFree = false;
 		return gv->draculaLocationHistory;
 	}
@@ -574,7 +890,7 @@ PlaceId *GvGetLastLocations(GameView gv, Player player, int numLocs,
 		
 	} else {
 		// Get the number of moves Dracula has made
-		int numMovesMade =  gv->round;
+		int numMovesMade =  gv->state.round;
 		
 		// If the number of moves requested is more than the number of
 		// moves Dracula has made, return only that many locations
@@ -590,14 +906,6 @@ PlaceId *GvGetLastLocations(GameView gv, Player player, int numLocs,
 ////////////////////////////////////////////////////////////////////////
 // Making a Move
 
-static bool isForbiddenMove(Player player, PlaceId place);
-static void addRoadConnections(Map map, Player player, PlaceId from,
-                               bool *locations);
-static void addRailConnections(Map map, Player player, PlaceId from,
-                               bool *locations, int maxHops);
-static void addBoatConnections(Map map, Player player, PlaceId from,
-                               bool *locations);
-
 PlaceId *GvGetReachable(GameView gv, Player player, Round round,
                         PlaceId from, int *numReturnedLocs)
 {
@@ -609,67 +917,90 @@ PlaceId *GvGetReachableByType(GameView gv, Player player, Round round,
                               PlaceId from, bool road, bool rail,
                               bool boat, int *numReturnedLocs)
 {
-	bool locations[NUM_REAL_PLACES] = {};
-	locations[from] = true;
+	PlaceId *locations = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
+	assert(locations != NULL);
+	GvGetReachableByTypeInto(gv, player, round, from, road, rail, boat,
+	                         locations, numReturnedLocs);
+	return locations;
+}
+
+void GvGetReachableInto(GameView gv, Player player, Round round,
+                        PlaceId from, PlaceId locs[static NUM_REAL_PLACES],
+                        int *numReturnedLocs)
+{
+	GvGetReachableByTypeInto(gv, player, round, from, true, true, true,
+	                         locs, numReturnedLocs);
+}
+
+void GvGetReachableByTypeInto(GameView gv, Player player, Round round,
+                              PlaceId from, bool road, bool rail,
+                              bool boat, PlaceId locs[static NUM_REAL_PLACES],
+                              int *numReturnedLocs)
+{
+	int transportMask = (road ? BY_ROAD : 0) | (rail ? BY_RAIL : 0) |
+	                    (boat ? BY_BOAT : 0);
+	PlaceSet reachable = GvReachableMask(gv, player, round, from,
+	                                     transportMask);
+	*numReturnedLocs = placeSetToPlaces(reachable, locs);
+}
+
+PlaceSet GvReachableMask(GameView gv, Player player, Round round,
+                         PlaceId from, int transportMask)
+{
+	PlaceSet reachable = placeSetEmpty();
 	
-	if (road) {
-		addRoadConnections(gv->map, player, from, locations);
+	if (transportMask & BY_ROAD) {
+		reachable = placeSetUnion(reachable,
+		                          MapConnectionsMask(gv->map, from, ROAD));
 	}
-	if (rail) {
+	if ((transportMask & BY_RAIL) && player != PLAYER_DRACULA) {
 		int maxHops = (player + round) % 4;
-		addRailConnections(gv->map, player, from, locations, maxHops);
+		if (maxHops > 0) {
+			reachable = placeSetUnion(reachable,
+			                          MapRailMask(gv->map, from, maxHops));
+		}
 	}
-	if (boat) {
-		addBoatConnections(gv->map, player, from, locations);
+	if (transportMask & BY_BOAT) {
+		reachable = placeSetUnion(reachable,
+		                          MapConnectionsMask(gv->map, from, BOAT));
 	}
 	
-	return boolsToPlaces(locations, numReturnedLocs);
-}
-
-static bool isForbiddenMove(Player player, PlaceId place) {
-	return (player == PLAYER_DRACULA && place == ST_JOSEPH_AND_ST_MARY);
+	// Dracula may not move to the hospital
+	if (player == PLAYER_DRACULA) {
+		reachable = placeSetRemove(reachable, ST_JOSEPH_AND_ST_MARY);
+	}
+	
+	// Staying put is always possible
+	return placeSetAdd(reachable, from);
 }
 
-static void addRoadConnections(Map map, Player player, PlaceId from,
-                               bool *locations) {
-	ConnList curr = MapGetConnections(map, from);
-	for (; curr != NULL; curr = curr->next) {
-		if (curr->type == ROAD) {
-			if (!isForbiddenMove(player, curr->p)) {
-				locations[curr->p] = true;
-			}
+void GvGetHunterDistances(GameView gv, HunterDistances *hd)
+{
+	for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+	     hunter++) {
+		PlaceId from = gv->state.location[hunter];
+		if (!placeIsReal(from)) {
+			memset(hd->dist[hunter], HUNTER_DIST_UNKNOWN, NUM_REAL_PLACES);
+			continue;
 		}
+		
+		Round round = gv->state.round + (hunter < gv->state.player ? 1 : 0);
+		int phase = (hunter + round) % MAP_RAIL_PHASES;
+		memcpy(hd->dist[hunter], MAP_HUNTER_DIST[phase][from],
+		       NUM_REAL_PLACES);
 	}
-}
-
-static void addRailConnections(Map map, Player player, PlaceId from,
-                               bool *locations, int maxHops) {
-    locations[from] = true;
-    if (maxHops <= 0 || player == PLAYER_DRACULA) {
-        return;
-    }
-    
-    ConnList curr = MapGetConnections(map, from);
-    for (; curr != NULL; curr = curr->next) {
-        if (curr->type == RAIL) {
-            if (!isForbiddenMove(player, from)) {
-	            addRailConnections(map, player, curr->p, locations,
-	                               maxHops - 1);
-            }
-        }
-    }
-}
-
-static void addBoatConnections(Map map, Player player, PlaceId from,
-                               bool *locations) {
-    ConnList curr = MapGetConnections(map, from);
-    for (; curr != NULL; curr = curr->next) {
-        if (curr->type == BOAT) {
-			if (!isForbiddenMove(player, from)) {
-				locations[curr->p] = true;
+	
+	memcpy(hd->minDist, hd->dist[PLAYER_LORD_GODALMING], NUM_REAL_PLACES);
+	memset(hd->closest, PLAYER_LORD_GODALMING, NUM_REAL_PLACES);
+	for (Player hunter = PLAYER_DR_SEWARD; hunter < PLAYER_DRACULA;
+	     hunter++) {
+		for (int p = 0; p < NUM_REAL_PLACES; p++) {
+			if (hd->dist[hunter][p] < hd->minDist[p]) {
+				hd->minDist[p] = hd->dist[hunter][p];
+				hd->closest[p] = hunter;
 			}
 		}
-    }
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -686,4 +1017,105 @@ static int min(int num1, int num2) {
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
 
-// TODO
\ No newline at end of file
+Map GvGetMap(GameView gv)
+{
+	return gv->map;
+}
+
+void GvAppendPlay(GameView gv, char *play)
+{
+	processTurn(gv, playToTurn(play));
+}
+
+void GvUpdate(GameView gv, char *pastPlays)
+{
+	int numTurns = pastPlaysToNumTurns(pastPlays);
+	
+	// A play the view has seen was rewritten (or the string is from an
+	// earlier turn), so start again
+	if (!sawPlays(gv, pastPlays, numTurns)) initState(gv);
+	processPlays(gv, pastPlays, numTurns);
+}
+
+void GvUpdateFromTurns(GameView gv, TurnBuffer *buf)
+{
+	if (!sawTurns(gv, buf)) initState(gv);
+	processTurnBuffer(gv, buf);
+}
+
+/**
+ * The same as sawPlays, for plays decoded into a TurnBuffer
+ */
+static bool sawTurns(GameView gv, TurnBuffer *buf) {
+	if (buf->numTurns < gv->numTurns) return false;
+	
+	for (int i = PLAYER_DRACULA; i < gv->numTurns; i += NUM_PLAYERS) {
+		if (buf->moves[i] != gv->moveHistory[PLAYER_DRACULA][i / NUM_PLAYERS]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Checks whether the plays that the view has seen are still the start
+ * of `pastPlays`, which has numTurns plays. Only Dracula's moves are
+ * compared, since they are the only plays the game engine rewrites -
+ * when a hidden move (C? or S?) is revealed.
+ */
+static bool sawPlays(GameView gv, char *pastPlays, int numTurns) {
+	if (numTurns < gv->numTurns) return false;
+	
+	for (int i = PLAYER_DRACULA; i < gv->numTurns; i += NUM_PLAYERS) {
+		PlaceId move = mapAbbrevToId(&pastPlays[i * 8 + 1]);
+		if (move != gv->moveHistory[PLAYER_DRACULA][i / NUM_PLAYERS]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int GvGetNumTurns(GameView gv)
+{
+	return gv->numTurns;
+}
+
+void GvApplyMove(GameView gv, Player player, PlaceId move,
+                 char *encounters, GvUndo *undo)
+{
+	assert(player == gv->state.player);
+	undo->state = gv->state;
+	undo->numTurns = gv->numTurns;
+	
+	char derived[4];
+	if (encounters == NULL) {
+		deriveEncounters(gv, player, move, derived);
+		encounters = derived;
+	}
+	processTurn(gv, moveToTurn(player, move, encounters));
+}
+
+void GvGetEncounters(GameView gv, Player player, PlaceId move,
+                     char encounters[4])
+{
+	assert(player == gv->state.player);
+	deriveEncounters(gv, player, move, encounters);
+}
+
+void GvUndoMove(GameView gv, GvUndo *undo)
+{
+	// The move's history entries are simply left beyond the end of the
+	// history, to be overwritten by the next move
+	gv->state = undo->state;
+	gv->numTurns = undo->numTurns;
+}
+
+GameState GvGetState(GameView gv)
+{
+	return gv->state;
+}
+
+uint64_t GvHash(GameView gv)
+{
+	return gv->state.hash;
+}
@@ -17,10 +17,14 @@
 #define FOD__GAME_VIEW_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "Game.h"
 #include "Places.h"
 // add your own #includes here
+#include "Map.h"
+#include "PlaceSet.h"
+#include "Plays.h"
 
 typedef struct gameView *GameView;
 
@@ -254,6 +258,179 @@ PlaceId *GvGetReachableByType(GameView gv, Player player, Round round,
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
 
+/**
+ * Gets the map used by the given view. The map is shared between every
+ * view, so it should NOT be freed.
+ */
+Map GvGetMap(GameView gv);
+
+/**
+ * Applies a single play (e.g. "DCD.V..") to the given view, as if it had
+ * been at the end of the pastPlays string. Only the new play is
+ * processed - the earlier plays are not parsed or replayed again.
+ *
+ * Arrays returned by earlier calls to the Game History functions may be
+ * invalidated, since the history may need to grow.
+ */
+void GvAppendPlay(GameView gv, char *play);
+
+/**
+ * Brings the given view up to date with `pastPlays`, a pastPlays string
+ * from the same game (e.g., the string for a later turn). Usually only
+ * the plays the view hasn't seen yet are applied, so a view can be kept
+ * for the whole game and updated cheaply each turn.
+ *
+ * The game engine rewrites Dracula's earlier moves when they are
+ * revealed (C? or S? becomes the real place), so the moves the view has
+ * already seen are checked against `pastPlays` too. If one has changed,
+ * or `pastPlays` has fewer plays than the view has seen, the view is
+ * rebuilt from the whole string, as GvNew would.
+ */
+void GvUpdate(GameView gv, char *pastPlays);
 
+/**
+ * The same as GvUpdate, but with the plays already decoded by
+ * TurnBufferParse (see Plays.h). For replaying many logged games: each
+ * string is parsed once, in bulk, and e.g. GvNew("", NULL) followed by
+ * this gives the same view as GvNew on the string.
+ */
+void GvUpdateFromTurns(GameView gv, TurnBuffer *buf);
+
+/**
+ * Gets the number of plays that have been applied to the view.
+ */
+int GvGetNumTurns(GameView gv);
+
+/**
+ * Creates an independent copy of the given view, e.g. for another thread
+ * to search ahead on. Free it with GvFree.
+ */
+GameView GvClone(GameView gv);
+
+/**
+ * Everything about the game that matters for which moves are legal and
+ * what the score is - but none of the history. It is plain data (about
+ * 50 bytes), so it can be copied, compared and kept in arrays by value.
+ * PlaceIds and Players are stored in single bytes.
+ */
+typedef struct gameState {
+	uint64_t hash;                           // see GvHash
+	int16_t  round;                          // current round number
+	int16_t  score;                          // game score
+	int16_t  health[NUM_PLAYERS];            // health of each player
+	int8_t   player;                         // current player
+	int8_t   location[NUM_PLAYERS];          // location of each player
+	int8_t   trailMoves[TRAIL_SIZE];         // Dracula's last moves and
+	int8_t   trailLocations[TRAIL_SIZE];     // their locations, most
+	int8_t   trailLength;                    // recent first
+	int8_t   traps[TRAIL_SIZE];              // locations of active traps,
+	int8_t   numTraps;                       // in no particular order
+	int8_t   vampire;                        // the immature vampire
+} GameState;
+
+/**
+ * Gets a copy of the current state of the game.
+ */
+GameState GvGetState(GameView gv);
+
+/**
+ * Gets a 64-bit Zobrist hash of the current state, for spotting the
+ * same position reached by different moves (e.g. in a transposition
+ * table). It covers the player locations, healths, Dracula's trail,
+ * the traps, the vampire, the current player and the round (which
+ * decides the rail phase and when the vampire matures) - but not the
+ * score. It is kept up to date as moves are made, so getting it costs
+ * nothing.
+ */
+uint64_t GvHash(GameView gv);
+
+/**
+ * What GvApplyMove saves so that GvUndoMove can take the move back.
+ * Keep it on the stack - nothing in it needs to be freed.
+ */
+typedef struct gvUndo {
+	GameState state;
+	int       numTurns;
+} GvUndo;
+
+/**
+ * Makes a move for the given player (who must be the current player) in
+ * place, and saves what is needed to take it back in *undo. `move` is
+ * given as it would appear in the play string (so Dracula's move may be
+ * HIDE, DOUBLE_BACK_n or TELEPORT), and `encounters` is the four
+ * characters that would follow it, e.g. "TD..". If `encounters` is NULL,
+ * they are worked out from the current state, as the game engine would.
+ *
+ * Nothing is allocated, except that the history occasionally grows when
+ * the game goes past the longest it has been.
+ */
+void GvApplyMove(GameView gv, Player player, PlaceId move,
+                 char *encounters, GvUndo *undo);
+
+/**
+ * Works out the four encounter characters that would follow the given
+ * move by the given player (who must be the current player) in the play
+ * string, as the game engine would - e.g. "T..." for a hunter walking
+ * into a trap. `move` is as for GvApplyMove.
+ */
+void GvGetEncounters(GameView gv, Player player, PlaceId move,
+                     char encounters[4]);
+
+/**
+ * Takes back the move that saved *undo. Moves must be undone in the
+ * reverse order to which they were applied.
+ */
+void GvUndoMove(GameView gv, GvUndo *undo);
+
+/**
+ * The same as GvGetReachable and GvGetReachableByType, but the locations
+ * are written to `locs` (e.g. an array on the caller's stack) instead
+ * of a newly allocated array.
+ */
+void GvGetReachableInto(GameView gv, Player player, Round round,
+                        PlaceId from, PlaceId locs[static NUM_REAL_PLACES],
+                        int *numReturnedLocs);
+void GvGetReachableByTypeInto(GameView gv, Player player, Round round,
+                              PlaceId from, bool road, bool rail,
+                              bool boat, PlaceId locs[static NUM_REAL_PLACES],
+                              int *numReturnedLocs);
+
+// Types of transport for GvReachableMask - combine them with |
+enum {
+	BY_ROAD = 1 << ROAD,
+	BY_RAIL = 1 << RAIL,
+	BY_BOAT = 1 << BOAT,
+	BY_ANY  = BY_ROAD | BY_RAIL | BY_BOAT,
+};
+
+/**
+ * Similar to GvGetReachableByType, but returns the locations as a set,
+ * so nothing is allocated. `transportMask` is a combination of BY_ROAD,
+ * BY_RAIL and BY_BOAT (or BY_ANY).
+ */
+PlaceSet GvReachableMask(GameView gv, Player player, Round round,
+                         PlaceId from, int transportMask);
+
+// Distance to a place from a hunter who hasn't moved yet
+#define HUNTER_DIST_UNKNOWN 255
+
+typedef struct hunterDistances {
+	// The number of moves each hunter needs to reach each place from
+	// where they are now (0 if they're there)
+	unsigned char dist[NUM_PLAYERS - 1][NUM_REAL_PLACES];
+	// The smallest of those for each place, and the hunter it belongs
+	// to (the first one, if several are as close)
+	unsigned char minDist[NUM_REAL_PLACES];
+	signed char   closest[NUM_REAL_PLACES];
+} HunterDistances;
+
+/**
+ * Fills *hd with the distances from every hunter to every place at once.
+ * Each hunter's distances take into account how far they can go by rail
+ * on each of their coming moves, starting from their next one. Every
+ * field is copied or derived from the precomputed tables in MapData.h,
+ * so no search is done.
+ */
+void GvGetHunterDistances(GameView gv, HunterDistances *hd);
 
 #endif // !defined (FOD__GAME_VIEW_H_)
@@ -21,20 +21,59 @@
 #include "Map.h"
 #include "Places.h"
 // add your own #includes here
-#include "Queue.h"
+#include "MapData.h"
 #include "utils.h"
 
+// How many of Dracula's moves the belief state remembers. A DOUBLE_BACK
+// can refer back TRAIL_SIZE - 1 moves from any move that's still in the
+// trail, so this is enough to replay the whole trail.
+#define BELIEF_HISTORY (2 * TRAIL_SIZE)
+
+// What the hunters know about one of Dracula's moves
+typedef struct draculaBelief {
+	PlaceId move;          // the move as it appears in the play string
+	bool placedEncounter;  // he placed a trap or vampire (so on land)
+	bool placedTrap;
+	bool placedVampire;
+	PlaceSet allowed;      // where the hunters' plays say he could be
+	PlaceSet candidates;   // where he could have been after the move
+} DraculaBelief;
+
 struct hunterView {
 	GameView gv;
-	Map map;
 	char *pastPlays;
+	size_t pastPlaysLength;
+	size_t pastPlaysCapacity;
+	
+	// beliefs[0] is Dracula's latest move, beliefs[1] the one before...
+	DraculaBelief beliefs[BELIEF_HISTORY];
+	int numDraculaMoves;
+	size_t beliefLength;   // how much of pastPlays the beliefs include
+	
+	// The chance he is in each place, given what the hunters have seen
+	float draculaProbs[MAP_PROB_STRIDE];
 };
 
-static PlaceId *hunterBfs(HunterView hv, Player hunter, PlaceId src,
-                          Round r);
 static Round playerNextRound(HunterView hv, Player player);
+static int railPhase(Player player, Round round);
 static int max(int a, int b);
 
+static void resetBeliefs(HunterView hv);
+static void updateBeliefs(HunterView hv);
+static void addDraculaMove(HunterView hv, const char *play);
+static void addHunterMove(HunterView hv, const char *play);
+static void restrictBelief(HunterView hv, int k, PlaceSet allowed);
+static void replayBeliefs(HunterView hv, int from);
+static PlaceSet stepBelief(HunterView hv, int k);
+static PlaceSet draculaAnywhere(HunterView hv);
+static PlaceSet draculaNeighbours(HunterView hv, PlaceSet from);
+static PlaceSet trailBlocked(HunterView hv, int k);
+static bool isLocationMove(PlaceId move);
+static int numBeliefs(HunterView hv);
+static void propagateProbs(const float probs[MAP_PROB_STRIDE],
+                           float next[MAP_PROB_STRIDE]);
+static void conditionProbs(HunterView hv);
+
 ////////////////////////////////////////////////////////////////////////
 // Constructor/Destructor
 
@@ -47,19 +86,56 @@ HunterView HvNew(char *pastPlays, Message messages[])
 	}
 	
 	hv->gv = GvNew(pastPlays, messages);
-	hv->map = MapNew();
+	hv->pastPlaysLength = strlen(pastPlays);
+	hv->pastPlaysCapacity = hv->pastPlaysLength + 1;
 	hv->pastPlays = strdup(pastPlays);
+	if (hv->pastPlays == NULL) {
+		fprintf(stderr, "Couldn't allocate HunterView!\n");
+		exit(EXIT_FAILURE);
+	}
+	
+	resetBeliefs(hv);
+	updateBeliefs(hv);
 	return hv;
 }
 
 void HvFree(HunterView hv)
 {
 	GvFree(hv->gv);
-	MapFree(hv->map);
 	free(hv->pastPlays);
 	free(hv);
 }
 
+void HvUpdate(HunterView hv, char *pastPlays)
+{
+	GvUpdate(hv->gv, pastPlays);
+	
+	// If a play we've seen was rewritten (Dracula's move was revealed),
+	// the beliefs have to be worked out again from the start
+	size_t length = strlen(pastPlays);
+	size_t seen = hv->pastPlaysLength;
+	if (length < seen || memcmp(pastPlays, hv->pastPlays, seen) != 0) {
+		seen = 0;
+		resetBeliefs(hv);
+	}
+	
+	// Only copy the plays we haven't seen yet
+	if (length + 1 > hv->pastPlaysCapacity) {
+		hv->pastPlaysCapacity *= 2;
+		if (hv->pastPlaysCapacity < length + 1) {
+			hv->pastPlaysCapacity = length + 1;
+		}
+		hv->pastPlays = realloc(hv->pastPlays, hv->pastPlaysCapacity);
+		if (hv->pastPlays == NULL) {
+			fprintf(stderr, "Couldn't allocate HunterView!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	strcpy(&hv->pastPlays[seen], &pastPlays[seen]);
+	hv->pastPlaysLength = length;
+	updateBeliefs(hv);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Game State Information
 
@@ -118,72 +194,46 @@ PlaceId HvGetLastKnownDraculaLocation(HunterView hv, Round *round)
 PlaceId *HvGetShortestPathTo(HunterView hv, Player hunter, PlaceId dest,
                              int *pathLength)
 {
+	Map map = GvGetMap(hv->gv);
 	Round r = playerNextRound(hv, hunter);
 	PlaceId src = HvGetPlayerLocation(hv, hunter);
-	PlaceId *pred = hunterBfs(hv, hunter, src, r);
-	
-	// One pass to get the path length
-	int dist = 0;
-	PlaceId curr = dest;
-	while (curr != src) {
-		dist++;
-		curr = pred[curr];
-	}
+	int dist = MapHunterDistance(map, src, dest, railPhase(hunter, r));
 	
+	// Follow the precomputed first steps, one move (and round) at a time.
+	// The path is a shortest one and starts with the move a BFS from src
+	// would make, but after that each step is the first step from where
+	// the hunter has got to, so where there are ties the places in
+	// between can differ from the BFS's path
 	PlaceId *path = malloc(dist * sizeof(PlaceId));
-	// Another pass to copy the path in
-	int i = dist - 1;
-	curr = dest;
-	while (curr != src) {
+	PlaceId curr = src;
+	for (int i = 0; i < dist; i++) {
+		curr = MapHunterNextStep(map, curr, dest, railPhase(hunter, r + i));
 		path[i] = curr;
-		curr = pred[curr];
-		i--;
 	}
 	
-	free(pred);
 	*pathLength = dist;
 	return path;
 }
 
-/**
- * Performs a BFS for the given hunter starting at `src`, assuming the
- * round is `r`. Returns a predecessor array.
- */
-PlaceId *hunterBfs(HunterView hv, Player hunter, PlaceId src, Round r) {
-	PlaceId *pred = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
-	placesFill(pred, NUM_REAL_PLACES, -1);
-	pred[src] = src;
-	
-	Queue q1 = QueueNew(); // current round locations
-	Queue q2 = QueueNew(); // next round locations
-	
-	QueueEnqueue(q1, src);
-	while (!(QueueIsEmpty(q1) && QueueIsEmpty(q2))) {
-		PlaceId curr = QueueDequeue(q1);
-		int numReachable = 0;
-		PlaceId *reachable = GvGetReachable(hv->gv, hunter, r, curr,
-		                                    &numReachable);
-		
-		for (int i = 0; i < numReachable; i++) {
-			if (pred[reachable[i]] == -1) {
-				pred[reachable[i]] = curr;
-				QueueEnqueue(q2, reachable[i]);
-			}
-		}
-		free(reachable);
-		
-		// When we've exhausted the current round's locations, advance
-		// to the next round and swap the queues (so the next round's
-		// locations becomes the current round's locations)
-		if (QueueIsEmpty(q1)) {
-			Queue tmp = q1; q1 = q2; q2 = tmp; // swap queues
-			r++;
-		}
-	}
-	
-	QueueDrop(q1);
-	QueueDrop(q2);
-	return pred;
+int HvGetDistance(HunterView hv, Player hunter, PlaceId dest)
+{
+	Round r = playerNextRound(hv, hunter);
+	PlaceId src = HvGetPlayerLocation(hv, hunter);
+	return MapHunterDistance(GvGetMap(hv->gv), src, dest,
+	                         railPhase(hunter, r));
+}
+
+PlaceId HvGetNextStep(HunterView hv, Player hunter, PlaceId dest)
+{
+	Round r = playerNextRound(hv, hunter);
+	PlaceId src = HvGetPlayerLocation(hv, hunter);
+	return MapHunterNextStep(GvGetMap(hv->gv), src, dest,
+	                         railPhase(hunter, r));
+}
+
+void HvGetHunterDistances(HunterView hv, HunterDistances *hd)
+{
+	GvGetHunterDistances(hv->gv, hd);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -211,20 +261,121 @@ PlaceId *HvWhereCanTheyGo(HunterView hv, Player player,
 PlaceId *HvWhereCanTheyGoByType(HunterView hv, Player player,
                                 bool road, bool rail, bool boat,
                                 int *numReturnedLocs)
+{
+	PlaceId *locs = malloc(NUM_REAL_PLACES * sizeof(PlaceId));
+	assert(locs != NULL);
+	HvWhereCanTheyGoByTypeInto(hv, player, road, rail, boat, locs,
+	                           numReturnedLocs);
+	
+	// If the given player hasn't made a move or the given player is
+	// Dracula and his location hasn't been revealed, return NULL
+	if (*numReturnedLocs == 0) {
+		free(locs);
+		return NULL;
+	}
+	return locs;
+}
+
+void HvWhereCanIGoInto(HunterView hv, PlaceId locs[static NUM_REAL_PLACES],
+                       int *numReturnedLocs)
+{
+	HvWhereCanIGoByTypeInto(hv, true, true, true, locs, numReturnedLocs);
+}
+
+void HvWhereCanIGoByTypeInto(HunterView hv, bool road, bool rail, bool boat,
+                             PlaceId locs[static NUM_REAL_PLACES],
+                             int *numReturnedLocs)
+{
+	HvWhereCanTheyGoByTypeInto(hv, HvGetPlayer(hv), road, rail, boat,
+	                           locs, numReturnedLocs);
+}
+
+void HvWhereCanTheyGoInto(HunterView hv, Player player,
+                          PlaceId locs[static NUM_REAL_PLACES],
+                          int *numReturnedLocs)
+{
+	HvWhereCanTheyGoByTypeInto(hv, player, true, true, true, locs,
+	                           numReturnedLocs);
+}
+
+void HvWhereCanTheyGoByTypeInto(HunterView hv, Player player,
+                                bool road, bool rail, bool boat,
+                                PlaceId locs[static NUM_REAL_PLACES],
+                                int *numReturnedLocs)
 {
 	Round round = playerNextRound(hv, player);
 	
 	PlaceId location = GvGetPlayerLocation(hv->gv, player);
 	
 	// If the given player hasn't made a move or the given player is
-	// Dracula and his location hasn't been revealed, return NULL
+	// Dracula and his location hasn't been revealed, there are none
 	if (round == 0 || !placeIsReal(location)) {
 		*numReturnedLocs = 0;
-		return NULL;
+		return;
 	}
 	
-	return GvGetReachableByType(hv->gv, player, round, location, road,
-	                            rail, boat, numReturnedLocs);
+	GvGetReachableByTypeInto(hv->gv, player, round, location, road, rail,
+	                         boat, locs, numReturnedLocs);
+}
+
+PlaceSet HvReachableMask(HunterView hv, Player player, int transportMask)
+{
+	Round round = playerNextRound(hv, player);
+	PlaceId location = GvGetPlayerLocation(hv->gv, player);
+	if (round == 0 || !placeIsReal(location)) {
+		return placeSetEmpty();
+	}
+	
+	return GvReachableMask(hv->gv, player, round, location, transportMask);
+}
+
+PlaceSet HvGetDraculaCandidates(HunterView hv)
+{
+	if (hv->numDraculaMoves == 0) return draculaAnywhere(hv);
+	return hv->beliefs[0].candidates;
+}
+
+int HvGetNumDraculaCandidates(HunterView hv)
+{
+	return placeSetSize(HvGetDraculaCandidates(hv));
+}
+
+float HvGetDraculaProbability(HunterView hv, PlaceId location)
+{
+	if (!placeIsReal(location)) return 0;
+	return hv->draculaProbs[location];
+}
+
+void HvGetDraculaNextProbabilities(HunterView hv,
+                                   float probs[static NUM_REAL_PLACES])
+{
+	float next[MAP_PROB_STRIDE];
+	propagateProbs(hv->draculaProbs, next);
+	memcpy(probs, next, NUM_REAL_PLACES * sizeof(float));
+}
+
+float HvGetCaptureChance(HunterView hv, Player hunter, PlaceId location)
+{
+	if (!placeIsReal(location)) return 0;
+	
+	// Where he moves next if he isn't at `location` now, so the two ways
+	// of catching him don't overlap
+	float elsewhere[MAP_PROB_STRIDE];
+	float next[MAP_PROB_STRIDE];
+	memcpy(elsewhere, hv->draculaProbs, sizeof(elsewhere));
+	elsewhere[location] = 0;
+	propagateProbs(elsewhere, next);
+	
+	// The move after this one, from `location`
+	Map map = GvGetMap(hv->gv);
+	int phase = railPhase(hunter, playerNextRound(hv, hunter) + 1);
+	float chance = hv->draculaProbs[location];
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		if (next[p] > 0 && MapHunterDistance(map, location, p, phase) <= 1) {
+			chance += next[p];
+		}
+	}
+	return chance < 1 ? chance : 1; // rounding
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -237,12 +388,299 @@ static Round playerNextRound(HunterView hv, Player player) {
 	return HvGetRound(hv) + (player < HvGetPlayer(hv) ? 1 : 0);
 }
 
+/**
+ * Gets the rail phase of a move by the given player in the given round,
+ * which determines how far they can travel by rail
+ */
+static int railPhase(Player player, Round round) {
+	return (player + round) % 4;
+}
+
 // Returns the higher of two integers
 static int max(int a, int b)
 {
     return (a > b) ? a : b;
 }
 
+////////////////////////////////////////////////////////////////////////
+// Dracula's belief state
+
+/**
+ * Forgets every play, so the beliefs are as they were before the game
+ */
+static void resetBeliefs(HunterView hv) {
+	hv->numDraculaMoves = 0;
+	hv->beliefLength = 0;
+	for (int i = 0; i < MAP_PROB_STRIDE; i++) {
+		hv->draculaProbs[i] = 0;
+	}
+	conditionProbs(hv);
+}
+
+/**
+ * Adds the plays in pastPlays that the beliefs don't include yet
+ */
+static void updateBeliefs(HunterView hv) {
+	for (size_t i = hv->beliefLength; i + 7 <= hv->pastPlaysLength;
+	     i += 8) {
+		const char *play = &hv->pastPlays[i];
+		if (play[0] == 'D') {
+			addDraculaMove(hv, play);
+		} else {
+			addHunterMove(hv, play);
+		}
+		hv->beliefLength = i + 8;
+	}
+}
+
+static void addDraculaMove(HunterView hv, const char *play) {
+	memmove(&hv->beliefs[1], &hv->beliefs[0],
+	        (BELIEF_HISTORY - 1) * sizeof(DraculaBelief));
+	hv->numDraculaMoves++;
+	
+	DraculaBelief *b = &hv->beliefs[0];
+	b->move = mapAbbrevToId(&play[1]);
+	b->placedTrap = (play[3] == 'T');
+	b->placedVampire = (play[4] == 'V');
+	b->placedEncounter = b->placedTrap || b->placedVampire;
+	b->allowed = draculaAnywhere(hv);
+	b->candidates = stepBelief(hv, 0);
+	
+	float next[MAP_PROB_STRIDE];
+	propagateProbs(hv->draculaProbs, next);
+	memcpy(hv->draculaProbs, next, sizeof(next));
+	conditionProbs(hv);
+}
+
+/**
+ * A hunter's play tells us Dracula is where they are if they met him,
+ * and isn't if they didn't (unless traps killed them first). Traps and
+ * vampires they find are where Dracula was when he placed them.
+ */
+static void addHunterMove(HunterView hv, const char *play) {
+	if (hv->numDraculaMoves == 0) return;
+	
+	PlaceId location = mapAbbrevToId(&play[1]);
+	const char *encounters = &play[3];
+	bool metTrap = (memchr(encounters, 'T', 4) != NULL);
+	bool metVampire = (memchr(encounters, 'V', 4) != NULL);
+	bool metDracula = (memchr(encounters, 'D', 4) != NULL);
+	
+	if (metDracula) {
+		restrictBelief(hv, 0, placeSetOf(location));
+	} else if (!metTrap) {
+		PlaceSet allowed = placeSetRemove(draculaAnywhere(hv), location);
+		restrictBelief(hv, 0, allowed);
+	}
+	
+	// Only one move in the trail can have placed the encounter here
+	int limit = (numBeliefs(hv) < TRAIL_SIZE ? numBeliefs(hv) : TRAIL_SIZE);
+	int placedAt = -1;
+	int numPlaced = 0;
+	for (int k = 0; k < limit; k++) {
+		DraculaBelief *b = &hv->beliefs[k];
+		if ((metTrap && b->placedTrap) || (metVampire && b->placedVampire)) {
+			if (placeSetContains(b->candidates, location)) {
+				placedAt = k;
+				numPlaced++;
+			}
+		}
+	}
+	if (numPlaced == 1) {
+		restrictBelief(hv, placedAt, placeSetOf(location));
+	}
+	conditionProbs(hv);
+}
+
+/**
+ * Narrows down where Dracula could have been after his k'th most recent
+ * move, and works out what that means for his later moves
+ */
+static void restrictBelief(HunterView hv, int k, PlaceSet allowed) {
+	DraculaBelief *b = &hv->beliefs[k];
+	b->allowed = placeSetIntersect(b->allowed, allowed);
+	replayBeliefs(hv, k);
+}
+
+static void replayBeliefs(HunterView hv, int from) {
+	for (int k = from; k >= 0; k--) {
+		hv->beliefs[k].candidates = stepBelief(hv, k);
+	}
+}
+
+/**
+ * Works out where Dracula could have been after his k'th most recent
+ * move, from where he could have been before it
+ */
+static PlaceSet stepBelief(HunterView hv, int k) {
+	DraculaBelief *b = &hv->beliefs[k];
+	Map map = GvGetMap(hv->gv);
+	
+	// Before his first move (or before what we remember), he could
+	// have been anywhere
+	bool first = (k + 1 >= numBeliefs(hv));
+	PlaceSet before = (first ? draculaAnywhere(hv)
+	                         : hv->beliefs[k + 1].candidates);
+	PlaceSet next = (first ? draculaAnywhere(hv)
+	                       : draculaNeighbours(hv, before));
+	
+	// The trail only holds moves, so after a HIDE or DOUBLE_BACK he can
+	// make a location move to where he already is
+	if (!first && !isLocationMove(hv->beliefs[k + 1].move)) {
+		next = placeSetUnion(next, before);
+	}
+	
+	PlaceSet candidates;
+	PlaceSet fallback = draculaAnywhere(hv);
+	if (placeIsReal(b->move)) {
+		candidates = placeSetOf(b->move);
+	} else if (b->move == TELEPORT) {
+		candidates = placeSetOf(CASTLE_DRACULA);
+	} else if (b->move == CITY_UNKNOWN) {
+		fallback = placeSetDifference(MapTypeMask(map, LAND),
+		                              placeSetOf(ST_JOSEPH_AND_ST_MARY));
+		candidates = placeSetDifference(placeSetIntersect(next, fallback),
+		                                trailBlocked(hv, k));
+	} else if (b->move == SEA_UNKNOWN) {
+		fallback = MapTypeMask(map, SEA);
+		candidates = placeSetDifference(placeSetIntersect(next, fallback),
+		                                trailBlocked(hv, k));
+	} else if (b->move == HIDE) {
+		fallback = MapTypeMask(map, LAND);
+		candidates = placeSetIntersect(before, fallback);
+	} else if (b->move >= DOUBLE_BACK_1 && b->move <= DOUBLE_BACK_5) {
+		// Back to where he was n - 1 moves before his previous move,
+		// which is next to where he is (or the same place, after a HIDE)
+		int n = b->move - DOUBLE_BACK_1 + 1;
+		candidates = before;
+		if (n > 1) {
+			int target = k + n;
+			PlaceSet then = (target < numBeliefs(hv)
+			                 ? hv->beliefs[target].candidates
+			                 : draculaAnywhere(hv));
+			candidates = placeSetIntersect(then,
+			                               placeSetUnion(next, before));
+		}
+	} else {
+		candidates = next;
+	}
+	
+	// He only places encounters in cities
+	if (b->placedEncounter) {
+		candidates = placeSetIntersect(candidates, MapTypeMask(map, LAND));
+	}
+	candidates = placeSetIntersect(candidates, b->allowed);
+	
+	// If nothing fits, we've lost track of him
+	if (placeSetIsEmpty(candidates)) {
+		candidates = placeSetIntersect(fallback, b->allowed);
+		if (placeSetIsEmpty(candidates)) candidates = fallback;
+	}
+	return candidates;
+}
+
+/**
+ * Gets every place Dracula can be
+ */
+static PlaceSet draculaAnywhere(HunterView hv) {
+	Map map = GvGetMap(hv->gv);
+	PlaceSet all = placeSetUnion(MapTypeMask(map, LAND),
+	                             MapTypeMask(map, SEA));
+	return placeSetRemove(all, ST_JOSEPH_AND_ST_MARY);
+}
+
+/**
+ * Gets the places Dracula can move to (by road or boat) from any of the
+ * given places
+ */
+static PlaceSet draculaNeighbours(HunterView hv, PlaceSet from) {
+	Map map = GvGetMap(hv->gv);
+	PlaceSet neighbours = placeSetEmpty();
+	for (PlaceId p = placeSetNext(from, NOWHERE); p != NOWHERE;
+	     p = placeSetNext(from, p)) {
+		neighbours = placeSetUnion(neighbours,
+		                           MapConnectionsMask(map, p, ROAD));
+		neighbours = placeSetUnion(neighbours,
+		                           MapConnectionsMask(map, p, BOAT));
+	}
+	return placeSetRemove(neighbours, ST_JOSEPH_AND_ST_MARY);
+}
+
+/**
+ * Gets the places Dracula's k'th most recent move can't have been a
+ * location move to: the places of the location moves still in his trail
+ * at the time, where we know them
+ */
+static PlaceSet trailBlocked(HunterView hv, int k) {
+	PlaceSet blocked = placeSetEmpty();
+	for (int j = k + 1; j < k + TRAIL_SIZE && j < numBeliefs(hv); j++) {
+		DraculaBelief *b = &hv->beliefs[j];
+		if (isLocationMove(b->move) && placeSetSize(b->candidates) == 1) {
+			blocked = placeSetUnion(blocked, b->candidates);
+		}
+	}
+	return blocked;
+}
+
+static bool isLocationMove(PlaceId move) {
+	return placeIsReal(move) || move == CITY_UNKNOWN || move == SEA_UNKNOWN;
+}
+
+/**
+ * Moves the distribution on by one of Dracula's moves. This is a dense
+ * product with the MAP_DRACULA_MOVES table, written as a sum of scaled
+ * rows so that the inner loop has no dependencies between iterations
+ * and the compiler can vectorise it.
+ */
+static void propagateProbs(const float probs[MAP_PROB_STRIDE],
+                           float next[MAP_PROB_STRIDE]) {
+	for (int i = 0; i < MAP_PROB_STRIDE; i++) {
+		next[i] = 0;
+	}
+	for (PlaceId from = MIN_REAL_PLACE; from <= MAX_REAL_PLACE; from++) {
+		float p = probs[from];
+		if (p == 0) continue;
+		const float *row = MAP_DRACULA_MOVES[from];
+		for (int to = 0; to < MAP_PROB_STRIDE; to++) {
+			next[to] += p * row[to];
+		}
+	}
+}
+
+/**
+ * Rules out the places Dracula can't be (see HvGetDraculaCandidates)
+ * and rescales the rest. If the distribution has no weight left on any
+ * candidate, it becomes uniform over them.
+ */
+static void conditionProbs(HunterView hv) {
+	PlaceSet candidates = HvGetDraculaCandidates(hv);
+	float total = 0;
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		if (!placeSetContains(candidates, p)) hv->draculaProbs[p] = 0;
+		total += hv->draculaProbs[p];
+	}
+	
+	if (total > 0) {
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			hv->draculaProbs[p] /= total;
+		}
+	} else {
+		float uniform = 1.0f / placeSetSize(candidates);
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			hv->draculaProbs[p] = (placeSetContains(candidates, p)
+			                       ? uniform : 0);
+		}
+	}
+}
+
+/**
+ * Gets how many entries of hv->beliefs are in use
+ */
+static int numBeliefs(HunterView hv) {
+	return (hv->numDraculaMoves < BELIEF_HISTORY ? hv->numDraculaMoves
+	                                             : BELIEF_HISTORY);
+}
+
 
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
@@ -254,15 +692,11 @@ PlaceId recentTrapEncounter(HunterView hv, Round *trapRound) {
 	PlaceId trap = NOWHERE;
 	for (Round r = start; r <= round; r++) {
 		for (Player p = PLAYER_LORD_GODALMING; p < PLAYER_DRACULA; p++) {
-			if (r * 40 + p * 8 >= strlen(hv->pastPlays)) continue;
+			if (r * 40 + p * 8 >= hv->pastPlaysLength) continue;
 			for (int encounter = 3; encounter <= 7; encounter++) {
 				if (hv->pastPlays[r * 40 + p * 8 + encounter] == 'T') {
-					char loc[3];
-					loc[0] = hv->pastPlays[r * 40 + p * 8 + 1];
-					loc[1] = hv->pastPlays[r * 40 + p * 8 + 2];
-					loc[2] = '\0';
 					*trapRound = r;
-					trap = placeAbbrevToId(loc);
+					trap = mapAbbrevToId(&hv->pastPlays[r * 40 + p * 8 + 1]);
 				}
 			}
 		}
@@ -276,13 +710,10 @@ bool visited(HunterView hv, PlaceId location) {
 	Round start = max(round - 1, 0);
 	for (Round r = start; r <= round; r++) {
 		for (Player p = PLAYER_LORD_GODALMING; p < PLAYER_DRACULA; p++) {
-			if (r * 40 + p * 8 >= strlen(hv->pastPlays)) continue;
+			if (r * 40 + p * 8 >= hv->pastPlaysLength) continue;
 			// Location
-			char loc[3];
-			loc[0] = hv->pastPlays[r * 40 + p * 8 + 1];
-			loc[1] = hv->pastPlays[r * 40 + p * 8 + 2];
-			loc[2] = '\0';
-			if (placeAbbrevToId(loc) == location) return true;
+			PlaceId loc = mapAbbrevToId(&hv->pastPlays[r * 40 + p * 8 + 1]);
+			if (loc == location) return true;
 		}
 	}
 	return false;
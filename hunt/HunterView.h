@@ -21,6 +21,7 @@
 #include "Game.h"
 #include "Places.h"
 // add your own #includes here
+#include "GameView.h"
 
 typedef struct hunterView *HunterView;
 
@@ -215,6 +216,104 @@ PlaceId *HvWhereCanTheyGoByType(HunterView hv, Player player,
 ////////////////////////////////////////////////////////////////////////
 // Your own interface functions
 
+/**
+ * Brings the given view up to date with `pastPlays`, a later pastPlays
+ * string from the same game (see GvUpdate). Usually only the new plays
+ * are processed, so one view can be kept for the whole game; if earlier
+ * plays were rewritten (when Dracula's moves are revealed), the view is
+ * worked out again from the whole string.
+ */
+void HvUpdate(HunterView hv, char *pastPlays);
+
+/**
+ * The same as HvWhereCanIGo, HvWhereCanIGoByType, HvWhereCanTheyGo and
+ * HvWhereCanTheyGoByType, but the locations are written to `locs` (e.g.
+ * an array on the caller's stack) instead of a newly allocated array.
+ * *numReturnedLocs is set to 0 where those functions would return NULL.
+ */
+void HvWhereCanIGoInto(HunterView hv, PlaceId locs[static NUM_REAL_PLACES],
+                       int *numReturnedLocs);
+void HvWhereCanIGoByTypeInto(HunterView hv, bool road, bool rail, bool boat,
+                             PlaceId locs[static NUM_REAL_PLACES],
+                             int *numReturnedLocs);
+void HvWhereCanTheyGoInto(HunterView hv, Player player,
+                          PlaceId locs[static NUM_REAL_PLACES],
+                          int *numReturnedLocs);
+void HvWhereCanTheyGoByTypeInto(HunterView hv, Player player,
+                                bool road, bool rail, bool boat,
+                                PlaceId locs[static NUM_REAL_PLACES],
+                                int *numReturnedLocs);
+
+/**
+ * Similar to HvWhereCanTheyGoByType, but returns the locations as a set
+ * (empty  if  the  player hasn't moved, or is Dracula and his location
+ * isn't known), so nothing is allocated. `transportMask` is a
+ * combination of BY_ROAD, BY_RAIL and BY_BOAT (see GameView.h).
+ */
+PlaceSet HvReachableMask(HunterView hv, Player player, int transportMask);
+
+/**
+ * Gets the number of moves the given hunter needs to reach `dest` from
+ * their current location (0 if they are already there), taking into
+ * account how far they can travel by rail on each move. This is a table
+ * lookup, so it is much cheaper than HvGetShortestPathTo.
+ */
+int HvGetDistance(HunterView hv, Player hunter, PlaceId dest);
+
+/**
+ * Gets the first move on a shortest path from the given hunter's current
+ * location to `dest` (the same as the first element of the path given
+ * by HvGetShortestPathTo), or their current location if they are already
+ * at `dest`.
+ */
+PlaceId HvGetNextStep(HunterView hv, Player hunter, PlaceId dest);
+
+/**
+ * Fills *hd with every hunter's distance to every place, and the
+ * closest hunter to each place (see GvGetHunterDistances), without
+ * a search per hunter.
+ */
+void HvGetHunterDistances(HunterView hv, HunterDistances *hd);
+
+/**
+ * Gets the places Dracula could be in right now, as far as the hunters
+ * can tell from the play string: his revealed moves, C? and S? moves,
+ * HIDEs and DOUBLE_BACKs, the trail rules, where the hunters have (and
+ * haven't) met him, and the traps and vampires they've found. This is
+ * kept up to date as plays are added, so it costs nothing to ask for.
+ * Before Dracula's first move, he could be anywhere but the hospital.
+ */
+PlaceSet HvGetDraculaCandidates(HunterView hv);
+
+/**
+ * Gets the number of places in HvGetDraculaCandidates.
+ */
+int HvGetNumDraculaCandidates(HunterView hv);
+
+/**
+ * Gets the chance that Dracula is at the given place right now. Between
+ * the plays that tell the hunters something, he is assumed to choose
+ * uniformly from his possible moves (see MAP_DRACULA_MOVES in
+ * MapData.h); the distribution is then restricted to the places in
+ * HvGetDraculaCandidates. Like those, it's updated as plays are added.
+ */
+float HvGetDraculaProbability(HunterView hv, PlaceId location);
+
+/**
+ * Gets the chance that Dracula will be at each place after his next
+ * move, into `probs` (indexed by PlaceId).
+ */
+void HvGetDraculaNextProbabilities(HunterView hv,
+                                   float probs[static NUM_REAL_PLACES]);
+
+/**
+ * Estimates the chance that the given hunter catches Dracula if they
+ * move to `location` on their next move: either he's there now, or he
+ * isn't and they can get to wherever he moves next on the move after.
+ * The two don't overlap, so this is a probability (from 0 to 1).
+ */
+float HvGetCaptureChance(HunterView hv, Player hunter, PlaceId location);
+
 // Returns most recent trap encounter
 PlaceId recentTrapEncounter(HunterView hv, Round *trapRound);
 // Already been in previous round
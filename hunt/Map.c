@@ -18,57 +18,33 @@
 #include <sysexits.h>
 
 #include "Map.h"
+#include "MapData.h"
 #include "Places.h"
 
+// The map is built from the read-only tables in MapData.c, which are
+// generated at build time, so there is only ever one (static) map
 struct map {
 	int nV; // number of vertices
-	int nE; // number of edges
-	ConnList connections[NUM_REAL_PLACES];
 };
 
-static void addConnections(Map m);
-static void addConnection(Map m, PlaceId v, PlaceId w, TransportType type);
-static inline bool isSentinelEdge(Connection c);
-
-static ConnList connListInsert(ConnList l, PlaceId v, TransportType type);
-static bool connListContains(ConnList l, PlaceId v, TransportType type);
+static struct map europe = {
+	.nV = NUM_REAL_PLACES,
+};
 
 ////////////////////////////////////////////////////////////////////////
 
 /** Creates a new map. */
-// #vertices always same as NUM_REAL_PLACES
+// No allocation or setup - the connections are all in MapData.c
 Map MapNew(void)
 {
-	Map m = malloc(sizeof(*m));
-	if (m == NULL) {
-		fprintf(stderr, "Couldn't allocate Map!\n");
-		exit(EXIT_FAILURE);
-	}
-
-	m->nV = NUM_REAL_PLACES;
-	m->nE = 0;
-	for (int i = 0; i < NUM_REAL_PLACES; i++) {
-		m->connections[i] = NULL;
-	}
-
-	addConnections(m);
-	return m;
+	return &europe;
 }
 
 /** Frees all memory allocated for the given map. */
+// Nothing to free - the map is static
 void MapFree(Map m)
 {
-	assert (m != NULL);
-
-	for (int i = 0; i < m->nV; i++) {
-		ConnList curr = m->connections[i];
-		while (curr != NULL) {
-			ConnList next = curr->next;
-			free(curr);
-			curr = next;
-		}
-	}
-	free(m);
+	assert(m != NULL);
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -78,9 +54,9 @@ void MapShow(Map m)
 {
 	assert(m != NULL);
 
-	printf("V = %d, E = %d\n", m->nV, m->nE);
+	printf("V = %d, E = %d\n", m->nV, MAP_NUM_CONNECTIONS);
 	for (int i = 0; i < m->nV; i++) {
-		for (ConnList curr = m->connections[i]; curr != NULL; curr = curr->next) {
+		for (ConnList curr = MapGetConnections(m, i); curr != NULL; curr = curr->next) {
 			printf("%s connects to %s by %s\n",
 			       placeIdToName((PlaceId) i),
 			       placeIdToName(curr->p),
@@ -107,11 +83,7 @@ int MapNumConnections(Map m, TransportType type)
 
 	int nE = 0;
 	for (int i = 0; i < m->nV; i++) {
-		for (ConnList curr = m->connections[i]; curr != NULL; curr = curr->next) {
-			if (curr->type == type || type == ANY) {
-				nE++;
-			}
-		}
+		nE += connRangeSize(MapGetConnectionRange(m, i, type));
 	}
 
 	return nE;
@@ -119,78 +91,75 @@ int MapNumConnections(Map m, TransportType type)
 
 ////////////////////////////////////////////////////////////////////////
 
-/// Add edges to Graph representing map of Europe
-static void addConnections(Map m)
+ConnList MapGetConnections(Map m, PlaceId p)
 {
 	assert(m != NULL);
+	assert(placeIsReal(p));
 
-	for (int i = 0; !isSentinelEdge(CONNECTIONS[i]); i++) {
-		addConnection(m, CONNECTIONS[i].v, CONNECTIONS[i].w, CONNECTIONS[i].t);
-	}
+	int first = MAP_EDGE_START[MAP_EDGE_INDEX(p, MIN_TRANSPORT)];
+	int last = MAP_EDGE_START[MAP_EDGE_INDEX(p + 1, MIN_TRANSPORT)];
+	// The nodes are never modified through the returned list
+	return (first == last ? NULL : (ConnList) &MAP_CONN_NODES[first]);
 }
 
-/// Add a new edge to the Map/Graph
-static void addConnection(Map m, PlaceId start, PlaceId end, TransportType type)
+ConnRange MapGetConnectionRange(Map m, PlaceId p, TransportType type)
 {
 	assert(m != NULL);
-	assert(start != end);
-	assert(placeIsReal(start));
-	assert(placeIsReal(end));
-	assert(transportTypeIsValid(type));
+	assert(placeIsReal(p));
+	assert(transportTypeIsValid(type) || type == ANY);
 
-	// don't add edges twice
-	if (connListContains(m->connections[start], end, type)) return;
+	int first = MAP_EDGE_INDEX(p, MIN_TRANSPORT);
+	int last = MAP_EDGE_INDEX(p + 1, MIN_TRANSPORT);
+	if (type != ANY) {
+		first = MAP_EDGE_INDEX(p, type);
+		last = first + 1;
+	}
 
-	m->connections[start] = connListInsert(m->connections[start], end, type);
-	m->connections[end]   = connListInsert(m->connections[end], start, type);
-	m->nE++;
+	return (ConnRange) {
+		.begin = &MAP_EDGES[MAP_EDGE_START[first]],
+		.end   = &MAP_EDGES[MAP_EDGE_START[last]],
+	};
 }
 
-/// Is this the magic 'sentinel' edge?
-static inline bool isSentinelEdge(Connection c)
-{
-	return c.v == -1 && c.w == -1 && c.t == ANY;
-}
+////////////////////////////////////////////////////////////////////////
 
-/// Insert a node into an adjacency list.
-static ConnList connListInsert(ConnList l, PlaceId p, TransportType type)
+PlaceSet MapConnectionsMask(Map m, PlaceId p, TransportType type)
 {
+	assert(m != NULL);
 	assert(placeIsReal(p));
-	assert(transportTypeIsValid(type));
-
-	ConnList new = malloc(sizeof(*new));
-	if (new == NULL) {
-		fprintf(stderr, "Couldn't allocate ConnNode");
-		exit(EXIT_FAILURE);
-	}
-	
-	new->p = p;
-	new->type = type;
-	new->next = l;
-	return new;
+	assert(type == ROAD || type == BOAT);
+	return (type == ROAD ? MAP_ROAD_MASK[p] : MAP_BOAT_MASK[p]);
 }
 
-/// Does this adjacency list contain a particular value?
-static bool connListContains(ConnList l, PlaceId p, TransportType type)
+PlaceSet MapRailMask(Map m, PlaceId p, int maxHops)
 {
+	assert(m != NULL);
 	assert(placeIsReal(p));
-	assert(transportTypeIsValid(type));
+	assert(maxHops >= 0 && maxHops <= MAP_MAX_RAIL_HOPS);
+	return MAP_RAIL_MASK[maxHops][p];
+}
 
-	for (ConnList curr = l; curr != NULL; curr = curr->next) {
-		if (curr->p == p && curr->type == type) {
-			return true;
-		}
-	}
-	
-	return false;
+PlaceSet MapTypeMask(Map m, PlaceType type)
+{
+	assert(m != NULL);
+	assert(type == LAND || type == SEA);
+	return MAP_TYPE_MASK[type];
 }
 
-////////////////////////////////////////////////////////////////////////
+int MapHunterDistance(Map m, PlaceId src, PlaceId dest, int railPhase)
+{
+	assert(m != NULL);
+	assert(placeIsReal(src) && placeIsReal(dest));
+	assert(railPhase >= 0 && railPhase < MAP_RAIL_PHASES);
+	return MAP_HUNTER_DIST[railPhase][src][dest];
+}
 
-ConnList MapGetConnections(Map m, PlaceId p)
+PlaceId MapHunterNextStep(Map m, PlaceId src, PlaceId dest, int railPhase)
 {
-	assert(placeIsReal(p));
-	return m->connections[p];
+	assert(m != NULL);
+	assert(placeIsReal(src) && placeIsReal(dest));
+	assert(railPhase >= 0 && railPhase < MAP_RAIL_PHASES);
+	return (PlaceId) MAP_HUNTER_NEXT[railPhase][src][dest];
 }
 
 ////////////////////////////////////////////////////////////////////////
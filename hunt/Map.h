@@ -13,6 +13,7 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "PlaceSet.h"
 #include "Places.h"
 
 #ifndef FOD__MAP_H_
@@ -28,10 +29,22 @@ struct connNode {
 // Map representation is hidden
 typedef struct map *Map;
 
-/** Creates a new map. */
+// A contiguous range of places connected to some place, taken from the
+// map's packed (compressed sparse row) adjacency array. Iterate with
+//     for (const PlaceId *p = r.begin; p < r.end; p++) ...
+typedef struct connRange {
+	const PlaceId *begin;
+	const PlaceId *end;
+} ConnRange;
+
+/**
+ *  Gets the map. There is only one map, which is shared by everyone who
+ *  calls this and never modified, so it is safe to borrow the returned
+ *  map for as long as you like.
+ */
 Map MapNew(void);
 
-/** Frees all memory allocated for the given map. */
+/** Releases the given map. Does nothing, since the map is shared. */
 void MapFree(Map m);
 
 /** Prints a map to `stdout`. */
@@ -49,4 +62,51 @@ int MapNumConnections(Map m, TransportType type);
  */
 ConnList MapGetConnections(Map m, PlaceId p);
 
+/**
+ *  Gets the range of places connected to the given place by the given
+ *  type of transport (ROAD, RAIL, BOAT, or ANY for all of them).
+ *  Within a place, road connections come first, then rail, then boat,
+ *  so each range is contiguous in memory.
+ *  The returned range should NOT be modified.
+ */
+ConnRange MapGetConnectionRange(Map m, PlaceId p, TransportType type);
+
+/**
+ *  Gets the set of places connected to the given place by road or by
+ *  boat (`type` must be ROAD or BOAT). Uses a precomputed table.
+ */
+PlaceSet MapConnectionsMask(Map m, PlaceId p, TransportType type);
+
+/**
+ *  Gets the set of places within `maxHops` (0 to 3) rail connections of
+ *  the given place, including the place itself. Uses a precomputed
+ *  table, so this is O(1) however far the rail network is explored.
+ */
+PlaceSet MapRailMask(Map m, PlaceId p, int maxHops);
+
+/**
+ *  Gets the set of real places of the given type (LAND or SEA).
+ */
+PlaceSet MapTypeMask(Map m, PlaceType type);
+
+/**
+ *  Gets the number of moves a hunter at `src` needs to reach `dest`.
+ *  `railPhase` is (player + round) % 4 for the hunter's first move,
+ *  which determines how far they can travel by rail on each move.
+ *  Uses a precomputed table, so this is O(1).
+ */
+int MapHunterDistance(Map m, PlaceId src, PlaceId dest, int railPhase);
+
+/**
+ *  Gets the first move on a shortest path for a hunter from `src` to
+ *  `dest` (see MapHunterDistance), or `src` if src == dest.
+ */
+PlaceId MapHunterNextStep(Map m, PlaceId src, PlaceId dest, int railPhase);
+
+/** Gets the number of places in a range of connections. */
+static inline int connRangeSize(ConnRange r)
+{
+	return (int) (r.end - r.begin);
+}
+
 #endif // !defined(FOD__MAP_H_)
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// MapData.h: read-only map tables generated at build time
+//
+// The tables declared here are defined in MapData.c, which is written
+// by genMapData (see the Makefile) from the PLACES and CONNECTIONS
+// tables in Places.c. Don't edit MapData.c by hand - change the
+// generator instead.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__MAP_DATA_H_
+#define FOD__MAP_DATA_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Game.h"
+#include "Map.h"
+#include "PlaceSet.h"
+#include "Places.h"
+
+#define MAP_NUM_TRANSPORTS ((int) MAX_TRANSPORT - (int) MIN_TRANSPORT + 1)
+
+// Index into MAP_EDGE_START of the first connection from place p by
+// transport t (ROAD, RAIL or BOAT)
+#define MAP_EDGE_INDEX(p, t) \
+	((p) * MAP_NUM_TRANSPORTS + ((int) (t) - (int) MIN_TRANSPORT))
+
+/** The number of distinct connections (each counted once). */
+extern const int MAP_NUM_CONNECTIONS;
+
+/**
+ * Packed (CSR) adjacency. The places connected to place p by transport
+ * t are MAP_EDGES[MAP_EDGE_START[i]] .. MAP_EDGES[MAP_EDGE_START[i + 1]
+ * - 1], where i = MAP_EDGE_INDEX(p, t). Every connection appears once
+ * in each direction.
+ */
+extern const int MAP_EDGE_START[NUM_REAL_PLACES * MAP_NUM_TRANSPORTS + 1];
+extern const PlaceId MAP_EDGES[];
+
+/**
+ * The same connections as linked lists, for MapGetConnections. Node i
+ * describes MAP_EDGES[i], and links to the next connection from the
+ * same place (or NULL).
+ */
+extern const struct connNode MAP_CONN_NODES[];
+
+/** The type (LAND or SEA) of each real place. */
+extern const PlaceType MAP_PLACE_TYPES[NUM_REAL_PLACES];
+
+/** The two-character abbreviation of each real place. */
+extern const char MAP_PLACE_ABBREVS[NUM_REAL_PLACES][3];
+
+/**
+ * Decodes the two-character abbreviation of a place or a special move
+ * (e.g. "C?", "HI", "D1", "TP") in constant time. Abbreviations only use
+ * upper-case letters, digits and '?', which stay distinct in their low 6
+ * bits, so the table is indexed by those 6 bits of each character. Other
+ * characters would alias them (e.g. "Dq" and "D1"), so they are checked
+ * for first. Abbreviations that don't exist decode to NOWHERE.
+ */
+#define MAP_ABBREV_INDEX(c0, c1) ((((c0) & 63) << 6) | ((c1) & 63))
+extern const signed char MAP_ABBREV_IDS[64 * 64];
+
+/** Checks whether `c` can be in an abbreviation. */
+static inline bool mapIsAbbrevChar(char c)
+{
+	return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '?';
+}
+
+static inline PlaceId mapAbbrevToId(const char *abbrev)
+{
+	if (!mapIsAbbrevChar(abbrev[0]) || !mapIsAbbrevChar(abbrev[1])) {
+		return NOWHERE;
+	}
+	return (PlaceId) MAP_ABBREV_IDS[MAP_ABBREV_INDEX(abbrev[0], abbrev[1])];
+}
+
+/**
+ * The places connected to each place by road and by boat, and the
+ * places within 0 to MAP_MAX_RAIL_HOPS rail connections of each place
+ * (MAP_RAIL_MASK[hops][p], which always includes p itself).
+ */
+#define MAP_MAX_RAIL_HOPS 3
+extern const PlaceSet MAP_ROAD_MASK[NUM_REAL_PLACES];
+extern const PlaceSet MAP_BOAT_MASK[NUM_REAL_PLACES];
+extern const PlaceSet MAP_RAIL_MASK[MAP_MAX_RAIL_HOPS + 1][NUM_REAL_PLACES];
+
+/** The real places of each type (LAND or SEA; UNKNOWN is empty). */
+extern const PlaceSet MAP_TYPE_MASK[SEA + 1];
+
+// How far a hunter can travel by rail depends only on
+// (player + round) % MAP_RAIL_PHASES - the "rail phase" of the move
+#define MAP_RAIL_PHASES 4
+
+/**
+ * All-pairs hunter distances. MAP_HUNTER_DIST[phase][src][dest] is the
+ * number of moves a hunter at `src` needs to reach `dest`, if the rail
+ * phase of their first move is `phase` (it advances by one each move).
+ * MAP_HUNTER_NEXT[phase][src][dest] is the first move on such a path,
+ * or `src` itself if src == dest.
+ */
+extern const unsigned char MAP_HUNTER_DIST[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES];
+extern const signed char MAP_HUNTER_NEXT[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES];
+
+/**
+ * Dracula's moves as a Markov chain: MAP_DRACULA_MOVES[p][q] is the
+ * chance he moves from p to q if he picks uniformly between staying put
+ * and each place he can reach by road or boat (never the hospital).
+ * Rows are padded to MAP_PROB_STRIDE floats, a whole number of vectors,
+ * so a loop over a row needs no scalar remainder.
+ */
+#define MAP_PROB_STRIDE 72
+extern const float MAP_DRACULA_MOVES[NUM_REAL_PLACES][MAP_PROB_STRIDE];
+
+/**
+ * Random keys for Zobrist hashing of GameStates (see GvHash). The hash
+ * of a state is the XOR of one key for each thing in it, so it can be
+ * updated by XORing keys out and in as the state changes. Keys are
+ * indexed by ZOBRIST_ID(p), which covers every PlaceId from NOWHERE to
+ * TELEPORT, by ZOBRIST_HEALTH_ID(health) and by ZOBRIST_ROUND_ID(round).
+ *
+ * There are at most GAME_START_SCORE rounds, and Dracula gains blood at
+ * Castle Dracula at most once a round, so the health keys cover every
+ * health anyone can have. Both are clamped to their tables, so a state
+ * past the end of the game (e.g. Dracula below 0) still hashes.
+ *
+ * ZOBRIST_TRAPS[n][p] stands for "n traps at p" - ZOBRIST_TRAPS[0] is
+ * all zeroes, so places without traps add nothing.
+ */
+#define ZOBRIST_NUM_IDS     ((int) TELEPORT - (int) NOWHERE + 1)
+#define ZOBRIST_ID(p)       ((int) (p) - (int) NOWHERE)
+#define ZOBRIST_NUM_HEALTHS (GAME_START_BLOOD_POINTS + \
+                             LIFE_GAIN_CASTLE_DRACULA * GAME_START_SCORE + 1)
+#define ZOBRIST_NUM_ROUNDS  (GAME_START_SCORE + 1)
+#define ZOBRIST_CLAMP(x, n) ((x) < 0 ? 0 : (x) >= (n) ? (n) - 1 : (x))
+#define ZOBRIST_HEALTH_ID(health) ZOBRIST_CLAMP(health, ZOBRIST_NUM_HEALTHS)
+#define ZOBRIST_ROUND_ID(round)   ZOBRIST_CLAMP(round, ZOBRIST_NUM_ROUNDS)
+extern const uint64_t ZOBRIST_LOCATION[NUM_PLAYERS][ZOBRIST_NUM_IDS];
+extern const uint64_t ZOBRIST_HEALTH[NUM_PLAYERS][ZOBRIST_NUM_HEALTHS];
+extern const uint64_t ZOBRIST_TRAIL_MOVE[TRAIL_SIZE][ZOBRIST_NUM_IDS];
+extern const uint64_t ZOBRIST_TRAIL_LOCATION[TRAIL_SIZE][ZOBRIST_NUM_IDS];
+extern const uint64_t ZOBRIST_TRAPS[TRAIL_SIZE + 1][ZOBRIST_NUM_IDS];
+extern const uint64_t ZOBRIST_VAMPIRE[ZOBRIST_NUM_IDS];
+extern const uint64_t ZOBRIST_PLAYER[NUM_PLAYERS];
+extern const uint64_t ZOBRIST_ROUND[ZOBRIST_NUM_ROUNDS];
+
+#endif // !defined(FOD__MAP_DATA_H_)
@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Match.c: the game engine's side of a game, for playing AIs locally
+//
+// The real state is kept in a GameView (for encounters and the hunters'
+// moves) and a DraculaView (for Dracula's moves), both brought up to
+// date after every play.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DraculaView.h"
+#include "Game.h"
+#include "GameView.h"
+#include "Match.h"
+#include "Places.h"
+#include "Plays.h"
+
+struct match {
+	GameView gv;                     // the real state of the game
+	DraculaView dv;                  // the same, for Dracula's moves
+	char plays[MATCH_PLAYS_SIZE];
+	int numTurns;
+	PlaceId draculaLocations[MATCH_MAX_ROUNDS];
+	bool revealed[MATCH_MAX_ROUNDS]; // if the hunters see each move
+};
+
+static bool isLegal(Match m, PlaceId move);
+static PlaceId firstLegalMove(Match m);
+static void revealTrail(Match m);
+
+////////////////////////////////////////////////////////////////////////
+
+Match MatchNew(void)
+{
+	Match m = malloc(sizeof(*m));
+	if (m == NULL) {
+		fprintf(stderr, "Couldn't allocate Match!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	m->plays[0] = '\0';
+	m->numTurns = 0;
+	m->gv = GvNew("", NULL);
+	m->dv = DvNew("", NULL);
+	return m;
+}
+
+void MatchFree(Match m)
+{
+	DvFree(m->dv);
+	GvFree(m->gv);
+	free(m);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+bool MatchIsOver(Match m)
+{
+	return GvGetScore(m->gv) <= 0 || GvGetHealth(m->gv, PLAYER_DRACULA) <= 0;
+}
+
+Player MatchGetPlayer(Match m)
+{
+	return GvGetPlayer(m->gv);
+}
+
+Round MatchGetRound(Match m)
+{
+	return GvGetRound(m->gv);
+}
+
+int MatchGetScore(Match m)
+{
+	return GvGetScore(m->gv);
+}
+
+int MatchGetHealth(Match m, Player player)
+{
+	return GvGetHealth(m->gv, player);
+}
+
+char *MatchGetPlays(Match m)
+{
+	return m->plays;
+}
+
+void MatchGetPastPlays(Match m, Player player, char *pastPlays)
+{
+	strcpy(pastPlays, m->plays);
+	if (player == PLAYER_DRACULA) return;
+
+	for (int turn = PLAYER_DRACULA; turn < m->numTurns; turn += NUM_PLAYERS) {
+		Round round = turn / NUM_PLAYERS;
+		char *play = pastPlays + turn * PLAY_SIZE;
+		char abbrev[3] = { play[1], play[2], '\0' };
+		PlaceId move = placeAbbrevToId(abbrev);
+		if (placeIsReal(move) && !m->revealed[round]) {
+			memcpy(play + 1, placeIsSea(move) ? "S?" : "C?", 2);
+		}
+	}
+}
+
+bool MatchPlay(Match m, PlaceId move)
+{
+	Player player = GvGetPlayer(m->gv);
+	Round round = GvGetRound(m->gv);
+	bool legal = isLegal(m, move);
+	if (!legal) move = firstLegalMove(m);
+
+	char encounters[4];
+	GvGetEncounters(m->gv, player, move, encounters);
+	char *play = m->plays + m->numTurns * PLAY_SIZE;
+	if (m->numTurns > 0) play[-1] = ' ';
+	snprintf(play, PLAY_SIZE, "%c%s%.4s", "GSHMD"[player],
+	         placeIdToAbbrev(move), encounters);
+	m->numTurns++;
+
+	GvAppendPlay(m->gv, play);
+	DvUpdate(m->dv, m->plays);
+	if (player == PLAYER_DRACULA) {
+		m->draculaLocations[round] = GvGetPlayerLocation(m->gv, PLAYER_DRACULA);
+		m->revealed[round] = false;
+	}
+	revealTrail(m);
+	return legal;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Rules
+
+static bool isLegal(Match m, PlaceId move)
+{
+	if (move == NOWHERE || move == UNKNOWN_PLACE) return false;
+
+	Player player = GvGetPlayer(m->gv);
+	PlaceId moves[NUM_REAL_PLACES];
+	int numMoves = 0;
+	PlaceId from = GvGetPlayerLocation(m->gv, player);
+	if (player == PLAYER_DRACULA) {
+		if (from == NOWHERE) {
+			return placeIsLand(move) && move != ST_JOSEPH_AND_ST_MARY;
+		}
+		DvGetValidMovesInto(m->dv, moves, &numMoves);
+		if (numMoves == 0) return move == TELEPORT;
+	} else {
+		if (from == NOWHERE) {
+			return placeIsReal(move) && move != ST_JOSEPH_AND_ST_MARY;
+		}
+		GvGetReachableInto(m->gv, player, GvGetRound(m->gv), from,
+		                   moves, &numMoves);
+	}
+
+	for (int i = 0; i < numMoves; i++) {
+		if (moves[i] == move) return true;
+	}
+	return false;
+}
+
+static PlaceId firstLegalMove(Match m)
+{
+	for (PlaceId move = MIN_REAL_PLACE; move <= TELEPORT; move++) {
+		if (isLegal(m, move)) return move;
+	}
+	return TELEPORT;
+}
+
+/**
+ * Reveals Dracula's moves in the trail to wherever a hunter is now, and
+ * his move to Castle Dracula
+ */
+static void revealTrail(Match m)
+{
+	Round round = GvGetRound(m->gv);
+	Round oldest = round - TRAIL_SIZE;
+	if (oldest < 0) oldest = 0;
+	for (Round r = oldest; r < round; r++) {
+		// Only rounds Dracula has moved in
+		if (r * NUM_PLAYERS + PLAYER_DRACULA >= m->numTurns) break;
+
+		PlaceId location = m->draculaLocations[r];
+		if (location == CASTLE_DRACULA) m->revealed[r] = true;
+		for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+		     hunter++) {
+			if (GvGetPlayerLocation(m->gv, hunter) == location)
+				m->revealed[r] = true;
+		}
+	}
+}
@@ -0,0 +1,74 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Match.h: the game engine's side of a game, for playing AIs locally
+//
+// A Match owns the real play string, applies each player's move to it
+// with the encounters the game engine would work out, and gives each
+// player the pastPlays they would get: Dracula sees every play, but the
+// hunters see his moves as C? or S? unless his location has been
+// revealed. A move is revealed if it is to Castle Dracula, or if a
+// hunter is in the same place while the move is still in his trail
+// (which includes a hunter finding him, or being there when he
+// arrives). HIDE, DOUBLE_BACK_n and TELEPORT moves, and every
+// encounter, are always shown.
+//
+// How the moves are decided (and timed) is up to the caller - see
+// referee.c and tournament.c.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__MATCH_H_
+#define FOD__MATCH_H_
+
+#include <stdbool.h>
+
+#include "Game.h"
+#include "Places.h"
+#include "Plays.h"
+
+// The game is over by then, since the score drops every round
+#define MATCH_MAX_ROUNDS (GAME_START_SCORE + 1)
+// Big enough for any pastPlays string from a match
+#define MATCH_PLAYS_SIZE (MATCH_MAX_ROUNDS * NUM_PLAYERS * PLAY_SIZE + 1)
+
+typedef struct match *Match;
+
+/** Starts a new game. */
+Match MatchNew(void);
+
+/** Frees all memory allocated for `m`. */
+void MatchFree(Match m);
+
+/** Checks whether the game is over (Dracula is dead or the score is 0). */
+bool MatchIsOver(Match m);
+
+/** Gets whose turn it is. */
+Player MatchGetPlayer(Match m);
+
+/** Gets the current round number. */
+Round MatchGetRound(Match m);
+
+/** Gets the current score. */
+int MatchGetScore(Match m);
+
+/** Gets the given player's current health. */
+int MatchGetHealth(Match m, Player player);
+
+/** Gets the real play string, with nothing hidden. */
+char *MatchGetPlays(Match m);
+
+/**
+ * Writes the pastPlays string that the given player would be given to
+ * `pastPlays`, which must hold MATCH_PLAYS_SIZE characters.
+ */
+void MatchGetPastPlays(Match m, Player player, char *pastPlays);
+
+/**
+ * Plays `move` (as registered, so Dracula's move may be HIDE etc.) for
+ * the current player. An illegal move (including NOWHERE, for no move
+ * at all) is replaced by the first legal one. Returns whether `move`
+ * was legal.
+ */
+bool MatchPlay(Match m, PlaceId move);
+
+#endif // !defined(FOD__MATCH_H_)
@@ -0,0 +1,345 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Mcts.c: information-set Monte Carlo tree search for hunters
+//
+// Playouts use the tables in MapData.h directly. Dracula moves by road
+// or boat, away from the hunters most of the time; the other hunters
+// chase the determinised Dracula some of the time and wander otherwise,
+// since in the real game they don't know where he is either. Dracula's
+// trail and everyone's health are left out - a playout only needs to
+// say how soon he is likely to be caught.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Game.h"
+#include "HunterView.h"
+#include "MapData.h"
+#include "Mcts.h"
+#include "PlaceSet.h"
+#include "Places.h"
+#include "Rng.h"
+
+// How many rounds a playout lasts
+#define PLAYOUT_ROUNDS 6
+// How much a catch is worth for each round it takes
+#define CATCH_DISCOUNT 0.85
+// How often the other hunters chase, and Dracula runs, in a playout
+// (out of 256)
+#define HUNTER_CHASE_CHANCE 128
+#define DRACULA_RUN_CHANCE  205
+// The exploration constant for UCB1
+#define EXPLORATION 0.7
+
+// The shared statistics are split into this many stripes, each with its
+// own lock, so workers adding to different moves don't wait
+#define NUM_STRIPES 8
+
+// Everything a playout needs to know
+typedef struct playout {
+	PlaceId hunters[NUM_PLAYERS - 1];
+	PlaceId dracula;
+	Round   round;
+	Player  player;  // whose turn it is
+} Playout;
+
+struct mcts {
+	Playout root;    // with Dracula's location still unknown
+	int     numMoves;
+	PlaceId moves[NUM_REAL_PLACES];
+
+	// Cumulative probabilities of Dracula's location, for sampling
+	float   cumulative[NUM_REAL_PLACES];
+
+	// The statistics of every worker together; moves[i] is in stripe
+	// i % NUM_STRIPES
+	pthread_mutex_t locks[NUM_STRIPES];
+	long    visits[NUM_REAL_PLACES];
+	double  rewards[NUM_REAL_PLACES];
+};
+
+struct mctsWorker {
+	Mcts    m;
+	long    numIterations;
+	int     visits[NUM_REAL_PLACES];
+	double  rewards[NUM_REAL_PLACES];
+
+	// What hasn't been added to the shared statistics yet
+	int     newVisits[NUM_REAL_PLACES];
+	double  newRewards[NUM_REAL_PLACES];
+
+	Rng     rng;
+};
+
+static int      selectMove(MctsWorker w);
+static PlaceId  sampleDracula(MctsWorker w);
+static double   playout(MctsWorker w, Playout p);
+static void     moveHunter(MctsWorker w, Playout *p);
+static void     moveDracula(MctsWorker w, Playout *p);
+static bool     hunterAt(Playout *p, PlaceId location);
+static PlaceId  randomPlace(MctsWorker w, PlaceSet s);
+
+////////////////////////////////////////////////////////////////////////
+
+Mcts MctsNew(HunterView hv)
+{
+	Mcts m = malloc(sizeof(*m));
+	if (m == NULL) {
+		fprintf(stderr, "Couldn't allocate Mcts!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	m->root.player = HvGetPlayer(hv);
+	m->root.round = HvGetRound(hv);
+	m->root.dracula = NOWHERE;
+	for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+	     hunter++) {
+		m->root.hunters[hunter] = HvGetPlayerLocation(hv, hunter);
+	}
+	assert(placeIsReal(m->root.hunters[m->root.player]));
+
+	HvWhereCanIGoInto(hv, m->moves, &m->numMoves);
+	for (int i = 0; i < m->numMoves; i++) {
+		m->visits[i] = 0;
+		m->rewards[i] = 0;
+	}
+	for (int i = 0; i < NUM_STRIPES; i++) {
+		pthread_mutex_init(&m->locks[i], NULL);
+	}
+
+	float total = 0;
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		total += HvGetDraculaProbability(hv, p);
+		m->cumulative[p] = total;
+	}
+	return m;
+}
+
+void MctsFree(Mcts m)
+{
+	for (int i = 0; i < NUM_STRIPES; i++) {
+		pthread_mutex_destroy(&m->locks[i]);
+	}
+	free(m);
+}
+
+MctsWorker MctsWorkerNew(Mcts m, uint64_t seed)
+{
+	MctsWorker w = malloc(sizeof(*w));
+	if (w == NULL) {
+		fprintf(stderr, "Couldn't allocate MctsWorker!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	w->m = m;
+	w->numIterations = 0;
+	for (int i = 0; i < m->numMoves; i++) {
+		w->visits[i] = w->newVisits[i] = 0;
+		w->rewards[i] = w->newRewards[i] = 0;
+	}
+
+	w->rng = rngNew(seed);
+	return w;
+}
+
+void MctsWorkerFree(MctsWorker w)
+{
+	free(w);
+}
+
+void MctsWorkerRun(MctsWorker w, int numIterations)
+{
+	Mcts m = w->m;
+	for (int n = 0; n < numIterations; n++) {
+		Playout p = m->root;
+		p.dracula = sampleDracula(w);
+
+		int i = selectMove(w);
+		p.hunters[p.player] = m->moves[i];
+		double reward = playout(w, p);
+		w->rewards[i] += reward;
+		w->newRewards[i] += reward;
+		w->visits[i]++;
+		w->newVisits[i]++;
+		w->numIterations++;
+	}
+
+	for (int stripe = 0; stripe < NUM_STRIPES; stripe++) {
+		pthread_mutex_lock(&m->locks[stripe]);
+		for (int i = stripe; i < m->numMoves; i += NUM_STRIPES) {
+			m->visits[i] += w->newVisits[i];
+			m->rewards[i] += w->newRewards[i];
+			w->newVisits[i] = 0;
+			w->newRewards[i] = 0;
+		}
+		pthread_mutex_unlock(&m->locks[stripe]);
+	}
+}
+
+PlaceId MctsBestMove(Mcts m)
+{
+	int best = 0;
+	long bestVisits = -1;
+	for (int stripe = 0; stripe < NUM_STRIPES; stripe++) {
+		pthread_mutex_lock(&m->locks[stripe]);
+		for (int i = stripe; i < m->numMoves; i += NUM_STRIPES) {
+			// Ties go to the first move, whatever the stripes
+			if (m->visits[i] > bestVisits ||
+			    (m->visits[i] == bestVisits && i < best)) {
+				bestVisits = m->visits[i];
+				best = i;
+			}
+		}
+		pthread_mutex_unlock(&m->locks[stripe]);
+	}
+	return bestVisits > 0 ? m->moves[best] : NOWHERE;
+}
+
+long MctsNumIterations(Mcts m)
+{
+	long total = 0;
+	for (int stripe = 0; stripe < NUM_STRIPES; stripe++) {
+		pthread_mutex_lock(&m->locks[stripe]);
+		for (int i = stripe; i < m->numMoves; i += NUM_STRIPES) {
+			total += m->visits[i];
+		}
+		pthread_mutex_unlock(&m->locks[stripe]);
+	}
+	return total;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Searching
+
+/**
+ * Picks the next move to try, by UCB1: every move once, then the one
+ * with the best average reward plus a bonus for being tried less
+ */
+static int selectMove(MctsWorker w) {
+	double logTotal = log((double) w->numIterations);
+	int best = 0;
+	double bestScore = -1;
+	for (int i = 0; i < w->m->numMoves; i++) {
+		if (w->visits[i] == 0) return i;
+		double score = w->rewards[i] / w->visits[i] +
+		               EXPLORATION * sqrt(logTotal / w->visits[i]);
+		if (score > bestScore) {
+			bestScore = score;
+			best = i;
+		}
+	}
+	return best;
+}
+
+/**
+ * Picks a place for Dracula from the hunters' distribution
+ */
+static PlaceId sampleDracula(MctsWorker w) {
+	float total = w->m->cumulative[MAX_REAL_PLACE];
+	float x = (rngNext(&w->rng) / 4294967296.0f) * total;
+	for (PlaceId p = MIN_REAL_PLACE; p < MAX_REAL_PLACE; p++) {
+		if (x < w->m->cumulative[p]) return p;
+	}
+	return MAX_REAL_PLACE;
+}
+
+/**
+ * Plays out the rest of the game from just after the current hunter's
+ * move, and returns how good it went for the hunters: CATCH_DISCOUNT to
+ * the power of the number of rounds it took to catch Dracula, or 0 if
+ * he got away
+ */
+static double playout(MctsWorker w, Playout p) {
+	double reward = 1;
+	Round end = p.round + PLAYOUT_ROUNDS;
+	while (true) {
+		if (hunterAt(&p, p.dracula)) return reward;
+
+		p.player++;
+		if (p.player > PLAYER_DRACULA) {
+			p.player = PLAYER_LORD_GODALMING;
+			p.round++;
+			reward *= CATCH_DISCOUNT;
+			if (p.round == end) return 0;
+		}
+
+		if (p.player == PLAYER_DRACULA) {
+			moveDracula(w, &p);
+		} else {
+			moveHunter(w, &p);
+		}
+	}
+}
+
+static void moveHunter(MctsWorker w, Playout *p) {
+	PlaceId from = p->hunters[p->player];
+	int phase = (p->player + p->round) % MAP_RAIL_PHASES;
+	if ((rngNext(&w->rng) & 255) < HUNTER_CHASE_CHANCE) {
+		p->hunters[p->player] = MAP_HUNTER_NEXT[phase][from][p->dracula];
+		return;
+	}
+
+	PlaceSet reachable = placeSetUnion(MAP_ROAD_MASK[from],
+	                                   MAP_BOAT_MASK[from]);
+	reachable = placeSetUnion(reachable, MAP_RAIL_MASK[phase][from]);
+	p->hunters[p->player] = randomPlace(w, placeSetAdd(reachable, from));
+}
+
+static void moveDracula(MctsWorker w, Playout *p) {
+	PlaceId from = p->dracula;
+	PlaceSet moves = placeSetUnion(MAP_ROAD_MASK[from], MAP_BOAT_MASK[from]);
+	moves = placeSetRemove(moves, ST_JOSEPH_AND_ST_MARY);
+	for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+	     hunter++) {
+		moves = placeSetRemove(moves, p->hunters[hunter]);
+	}
+	if (placeSetIsEmpty(moves)) return;
+
+	if ((rngNext(&w->rng) & 255) >= DRACULA_RUN_CHANCE) {
+		p->dracula = randomPlace(w, moves);
+		return;
+	}
+
+	// Run to wherever the nearest hunter is furthest away
+	int bestDist = -1;
+	for (PlaceId to = placeSetNext(moves, NOWHERE); to != NOWHERE;
+	     to = placeSetNext(moves, to)) {
+		int dist = NUM_REAL_PLACES;
+		for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+		     hunter++) {
+			int phase = (hunter + p->round + 1) % MAP_RAIL_PHASES;
+			int d = MAP_HUNTER_DIST[phase][p->hunters[hunter]][to];
+			if (d < dist) dist = d;
+		}
+		if (dist > bestDist) {
+			bestDist = dist;
+			p->dracula = to;
+		}
+	}
+}
+
+static bool hunterAt(Playout *p, PlaceId location) {
+	for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+	     hunter++) {
+		if (p->hunters[hunter] == location) return true;
+	}
+	return false;
+}
+
+/**
+ * Picks a place from a non-empty set, uniformly
+ */
+static PlaceId randomPlace(MctsWorker w, PlaceSet s) {
+	int k = rngBelow(&w->rng, placeSetSize(s));
+	PlaceId p = placeSetNext(s, NOWHERE);
+	while (k-- > 0) {
+		p = placeSetNext(s, p);
+	}
+	return p;
+}
@@ -0,0 +1,71 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Mcts.h: information-set Monte Carlo tree search for hunters
+//
+// The hunters never know for sure where Dracula is, so each iteration
+// of the search first picks a place for him from the HunterView's
+// probability distribution (a "determinisation"), then tries one of the
+// current hunter's moves against it by playing the game out for a few
+// rounds on a tiny state of just everyone's location. The statistics of
+// each move are shared across all the determinisations, which makes
+// this a single-level ISMCTS: the tree is the current hunter's choice
+// of move, and everything after that is a playout.
+//
+// The statistics live in an Mcts, which any number of MctsWorkers (say,
+// one per thread) add to at once. Each worker chooses moves by its own
+// statistics and only adds them to the shared ones every so often - a
+// root-parallel search - so workers hardly ever wait for each other.
+// The best move can be asked for at any time, so the caller can keep
+// registering better moves until it runs out of time.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__MCTS_H_
+#define FOD__MCTS_H_
+
+#include <stdint.h>
+
+#include "HunterView.h"
+#include "Places.h"
+
+typedef struct mcts *Mcts;
+typedef struct mctsWorker *MctsWorker;
+
+/**
+ * Creates a search for the current hunter's move in `hv`, which must be
+ * after their first move. The search copies what it needs, so `hv` can
+ * change or be freed.
+ */
+Mcts MctsNew(HunterView hv);
+
+/** Frees all memory allocated for `m`. Its workers must be freed first. */
+void MctsFree(Mcts m);
+
+/**
+ * Creates a worker for `m`. `seed` seeds the worker's random numbers, so
+ * the same seeds and numbers of iterations always give the same move.
+ * A worker must only be used by one thread at a time.
+ */
+MctsWorker MctsWorkerNew(Mcts m, uint64_t seed);
+
+/** Frees all memory allocated for `w`. */
+void MctsWorkerFree(MctsWorker w);
+
+/**
+ * Runs `numIterations` more iterations of the search, and adds them to
+ * the shared statistics. Can be called by several workers at once.
+ */
+void MctsWorkerRun(MctsWorker w, int numIterations);
+
+/**
+ * Gets the move that has been tried the most so far by all the workers
+ * (which, since moves are tried more often the better they do, is the
+ * best one), or NOWHERE if nothing has been tried yet. Can be called
+ * while workers are running.
+ */
+PlaceId MctsBestMove(Mcts m);
+
+/** Gets the number of iterations all the workers have run so far. */
+long MctsNumIterations(Mcts m);
+
+#endif // !defined(FOD__MCTS_H_)
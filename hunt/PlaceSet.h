@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// PlaceSet.h: sets of real places as 128-bit masks
+//
+// A PlaceSet is passed and returned by value - there is nothing to
+// allocate or free, and membership, union and intersection are a
+// couple of bitwise operations.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__PLACE_SET_H_
+#define FOD__PLACE_SET_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Places.h"
+
+#define PLACE_SET_WORDS 2
+
+// Bit (p % 64) of words[p / 64] is set if real place p is in the set
+typedef struct placeSet {
+	uint64_t words[PLACE_SET_WORDS];
+} PlaceSet;
+
+/** Gets the empty set. */
+static inline PlaceSet placeSetEmpty(void)
+{
+	return (PlaceSet) { { 0, 0 } };
+}
+
+/** Gets the set containing only the given place (empty if not real). */
+static inline PlaceSet placeSetOf(PlaceId p)
+{
+	PlaceSet s = placeSetEmpty();
+	if (placeIsReal(p)) {
+		s.words[p / 64] = (uint64_t) 1 << (p % 64);
+	}
+	return s;
+}
+
+/** Is the given place in the set? Non-real places never are. */
+static inline bool placeSetContains(PlaceSet s, PlaceId p)
+{
+	return placeIsReal(p) && ((s.words[p / 64] >> (p % 64)) & 1);
+}
+
+static inline PlaceSet placeSetUnion(PlaceSet a, PlaceSet b)
+{
+	return (PlaceSet) { { a.words[0] | b.words[0], a.words[1] | b.words[1] } };
+}
+
+static inline PlaceSet placeSetIntersect(PlaceSet a, PlaceSet b)
+{
+	return (PlaceSet) { { a.words[0] & b.words[0], a.words[1] & b.words[1] } };
+}
+
+/** Gets the places in `a` that aren't in `b`. */
+static inline PlaceSet placeSetDifference(PlaceSet a, PlaceSet b)
+{
+	return (PlaceSet) { { a.words[0] & ~b.words[0], a.words[1] & ~b.words[1] } };
+}
+
+static inline PlaceSet placeSetAdd(PlaceSet s, PlaceId p)
+{
+	return placeSetUnion(s, placeSetOf(p));
+}
+
+static inline PlaceSet placeSetRemove(PlaceSet s, PlaceId p)
+{
+	return placeSetDifference(s, placeSetOf(p));
+}
+
+static inline bool placeSetIsEmpty(PlaceSet s)
+{
+	return (s.words[0] | s.words[1]) == 0;
+}
+
+static inline bool placeSetEquals(PlaceSet a, PlaceSet b)
+{
+	return a.words[0] == b.words[0] && a.words[1] == b.words[1];
+}
+
+/** Gets the number of places in the set. */
+static inline int placeSetSize(PlaceSet s)
+{
+	return __builtin_popcountll(s.words[0]) + __builtin_popcountll(s.words[1]);
+}
+
+/**
+ * Gets the smallest place in the set that is greater than `p`, or
+ * NOWHERE if there isn't one. To iterate over a set:
+ *     for (PlaceId p = placeSetNext(s, NOWHERE); p != NOWHERE;
+ *          p = placeSetNext(s, p)) ...
+ */
+static inline PlaceId placeSetNext(PlaceSet s, PlaceId p)
+{
+	int from = (p < MIN_REAL_PLACE ? MIN_REAL_PLACE : p + 1);
+	for (int w = from / 64; w < PLACE_SET_WORDS; w++) {
+		uint64_t bits = s.words[w];
+		if (w == from / 64) {
+			bits &= ~(uint64_t) 0 << (from % 64);
+		}
+		if (bits != 0) {
+			return (PlaceId) (w * 64 + __builtin_ctzll(bits));
+		}
+	}
+	return NOWHERE;
+}
+
+/**
+ * Copies the places in the set, in increasing order, into `places`
+ * (which must have room for placeSetSize(s) places), and returns the
+ * number of places copied.
+ */
+static inline int placeSetToPlaces(PlaceSet s, PlaceId *places)
+{
+	int numPlaces = 0;
+	for (int w = 0; w < PLACE_SET_WORDS; w++) {
+		for (uint64_t bits = s.words[w]; bits != 0; bits &= bits - 1) {
+			places[numPlaces++] = (PlaceId) (w * 64 + __builtin_ctzll(bits));
+		}
+	}
+	return numPlaces;
+}
+
+#endif // !defined(FOD__PLACE_SET_H_)
@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Plays.c: a fast parser for pastPlays strings
+//
+// Every play but the last is exactly 8 bytes ("GED.... "), so blocks of
+// plays can be checked with a few vector comparisons against a pattern
+// of what each player's play must look like. The player letters repeat
+// every 5 plays, so the pattern is a 5-play table read at an offset.
+// The moves themselves are decoded with the abbreviation table from
+// MapData.h.
+//
+// Building with -mavx2 checks 4 plays at a time; otherwise SSE2 (which
+// every x86-64 compiler enables) checks 2. Defining PLAYS_NO_SIMD, or
+// building for anything else, uses only the scalar code.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+#include "MapData.h"
+#include "Places.h"
+#include "Plays.h"
+
+#if !defined(PLAYS_NO_SIMD) && defined(__AVX2__)
+# define PLAYS_AVX2
+# include <immintrin.h>
+#endif
+#if !defined(PLAYS_NO_SIMD) && defined(__SSE2__)
+# define PLAYS_SSE2
+# include <emmintrin.h>
+#endif
+
+static const char PLAYER_LETTERS[NUM_PLAYERS] = { 'G', 'S', 'H', 'M', 'D' };
+
+static void reserve(TurnBuffer *buf, int numTurns);
+static bool parsePlay(TurnBuffer *buf, const char *play, int i);
+static bool storeMove(TurnBuffer *buf, const char *play, int i);
+
+#if defined(PLAYS_SSE2) || defined(PLAYS_AVX2)
+static bool checkBlock(uint32_t matches, uint32_t abbrevs,
+                       uint32_t encounters, int numPlays);
+static void storeEncounters(TurnBuffer *buf, const uint8_t *codes, int i,
+                            int numPlays);
+#endif
+#ifdef PLAYS_SSE2
+static bool parseBlockSse2(TurnBuffer *buf, const char *plays, int i);
+#endif
+#ifdef PLAYS_AVX2
+static bool parseBlockAvx2(TurnBuffer *buf, const char *plays, int i);
+#endif
+
+////////////////////////////////////////////////////////////////////////
+
+void TurnBufferInit(TurnBuffer *buf)
+{
+	buf->numTurns = 0;
+	buf->capacity = 0;
+	buf->players = NULL;
+	buf->moves = NULL;
+	buf->encounters = NULL;
+}
+
+void TurnBufferFree(TurnBuffer *buf)
+{
+	free(buf->players);
+	free(buf->moves);
+	free(buf->encounters);
+	TurnBufferInit(buf);
+}
+
+/**
+ * Makes sure the buffer can hold at least numTurns turns
+ */
+static void reserve(TurnBuffer *buf, int numTurns)
+{
+	if (numTurns <= buf->capacity) return;
+
+	int capacity = (buf->capacity > 0 ? buf->capacity : 64);
+	while (capacity < numTurns) {
+		capacity *= 2;
+	}
+	buf->players = realloc(buf->players, capacity * sizeof(int8_t));
+	buf->moves = realloc(buf->moves, capacity * sizeof(int8_t));
+	buf->encounters = realloc(buf->encounters, capacity * sizeof(uint8_t));
+	if (buf->players == NULL || buf->moves == NULL ||
+	    buf->encounters == NULL) {
+		fprintf(stderr, "Couldn't allocate TurnBuffer!\n");
+		exit(EXIT_FAILURE);
+	}
+	buf->capacity = capacity;
+}
+
+bool TurnBufferParse(TurnBuffer *buf, const char *pastPlays)
+{
+	buf->numTurns = 0;
+
+	size_t length = strlen(pastPlays);
+	if (length == 0) return true;
+	if (length % PLAY_SIZE != PLAY_SIZE - 1) return false;
+
+	int numTurns = (length + 1) / PLAY_SIZE;
+	reserve(buf, numTurns);
+
+	// Every play before the last is followed by a space, so whole
+	// blocks of them can be read without going past the terminator
+	int i = 0;
+#ifdef PLAYS_AVX2
+	for (; i + 4 < numTurns; i += 4) {
+		if (!parseBlockAvx2(buf, pastPlays, i)) return false;
+	}
+#endif
+#ifdef PLAYS_SSE2
+	for (; i + 2 < numTurns; i += 2) {
+		if (!parseBlockSse2(buf, pastPlays, i)) return false;
+	}
+#endif
+	for (; i < numTurns; i++) {
+		const char *play = &pastPlays[i * PLAY_SIZE];
+		if (!parsePlay(buf, play, i)) return false;
+		if (i + 1 < numTurns && play[PLAY_SIZE - 1] != ' ') return false;
+	}
+
+	buf->numTurns = numTurns;
+	return true;
+}
+
+const char *TurnBufferParser(void)
+{
+#if defined(PLAYS_AVX2)
+	return "AVX2";
+#elif defined(PLAYS_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+uint8_t playEncodeEncounters(const char *encounters)
+{
+	uint8_t packed = 0;
+	for (int i = 0; i < PLAY_NUM_ENCOUNTERS; i++) {
+		EncounterCode code = ENCOUNTER_NONE;
+		switch (encounters[i]) {
+			case 'T': code = ENCOUNTER_TRAP;    break;
+			case 'V': code = ENCOUNTER_VAMPIRE; break;
+			case 'D': code = ENCOUNTER_OTHER;   break;
+			case 'M': code = ENCOUNTER_OTHER;   break;
+			default:                            break;
+		}
+		packed |= code << (2 * i);
+	}
+	return packed;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Scalar parsing
+
+/**
+ * Checks and decodes play i (without its trailing space)
+ */
+static bool parsePlay(TurnBuffer *buf, const char *play, int i)
+{
+	Player player = i % NUM_PLAYERS;
+	if (play[0] != PLAYER_LETTERS[player]) return false;
+
+	// Hunters never encounter a malfunction, and Dracula never
+	// encounters himself
+	char forbidden = (player == PLAYER_DRACULA ? 'D' : 'M');
+	for (int j = 3; j < 3 + PLAY_NUM_ENCOUNTERS; j++) {
+		if (play[j] == '\0' || play[j] == forbidden ||
+		    strchr(".TVDM", play[j]) == NULL) {
+			return false;
+		}
+	}
+
+	buf->encounters[i] = playEncodeEncounters(&play[3]);
+	return storeMove(buf, play, i);
+}
+
+/**
+ * Decodes the move in play i, and checks the player could make it
+ */
+static bool storeMove(TurnBuffer *buf, const char *play, int i)
+{
+	Player player = i % NUM_PLAYERS;
+	PlaceId move = mapAbbrevToId(&play[1]);
+	if (move == NOWHERE) return false;
+	if (player != PLAYER_DRACULA && !placeIsReal(move)) return false;
+
+	buf->players[i] = player;
+	buf->moves[i] = move;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Vector parsing
+
+#if defined(PLAYS_SSE2) || defined(PLAYS_AVX2)
+
+/**
+ * What the plays from play i onwards must look like, starting at byte
+ * (i % 5) * 8: the player's letter, the letter they can never have as
+ * an encounter, and a space. Long enough for 4 plays from any offset.
+ */
+static const char PLAY_PATTERN[(NUM_PLAYERS + 4) * PLAY_SIZE] = {
+	'G', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'S', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'H', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'M', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'D', 0, 0, 'D', 'D', 'D', 'D', ' ',
+	'G', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'S', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'H', 0, 0, 'M', 'M', 'M', 'M', ' ',
+	'M', 0, 0, 'M', 'M', 'M', 'M', ' ',
+};
+
+// Masks of the bytes of each 8-byte play, repeated for up to 4 plays
+#define EACH_PLAY(byteMask) ((uint32_t) (byteMask) * 0x01010101u)
+#define PLAY_FIXED_BYTES      0x81 // the player's letter and the space
+#define PLAY_ABBREV_BYTES     0x06 // the move
+#define PLAY_ENCOUNTER_BYTES  0x78 // the encounters
+
+/**
+ * Checks the byte masks from a block of numPlays plays: `matches` has
+ * the bytes that are equal to PLAY_PATTERN, `abbrevs` the bytes that can
+ * be in an abbreviation, and `encounters` the bytes that can be an
+ * encounter
+ */
+static bool checkBlock(uint32_t matches, uint32_t abbrevs,
+                       uint32_t encounters, int numPlays)
+{
+	uint32_t all = (numPlays == 4 ? ~0u : (1u << (numPlays * 8)) - 1);
+	uint32_t checked = EACH_PLAY(PLAY_FIXED_BYTES | PLAY_ENCOUNTER_BYTES);
+	return (matches & checked & all) == (EACH_PLAY(PLAY_FIXED_BYTES) & all) &&
+	       (abbrevs & EACH_PLAY(PLAY_ABBREV_BYTES) & all) ==
+	           (EACH_PLAY(PLAY_ABBREV_BYTES) & all) &&
+	       (encounters & EACH_PLAY(PLAY_ENCOUNTER_BYTES) & all) ==
+	           (EACH_PLAY(PLAY_ENCOUNTER_BYTES) & all);
+}
+
+/**
+ * Packs the encounter codes (one byte per character of the plays) of
+ * plays i .. i + numPlays - 1
+ */
+static void storeEncounters(TurnBuffer *buf, const uint8_t *codes, int i,
+                            int numPlays)
+{
+	for (int p = 0; p < numPlays; p++) {
+		uint64_t play;
+		memcpy(&play, &codes[p * PLAY_SIZE], sizeof(play));
+		uint64_t x = play >> 24; // bytes 3 .. 6, little-endian
+		buf->encounters[i + p] = (x & 0x03) | ((x >> 6) & 0x0c) |
+		                         ((x >> 12) & 0x30) | ((x >> 18) & 0xc0);
+	}
+}
+
+#endif
+
+#ifdef PLAYS_SSE2
+
+/**
+ * Checks and decodes plays i and i + 1
+ */
+static bool parseBlockSse2(TurnBuffer *buf, const char *plays, int i)
+{
+	const char *block = &plays[i * PLAY_SIZE];
+	__m128i v = _mm_loadu_si128((const __m128i *) block);
+	__m128i pattern = _mm_loadu_si128(
+		(const __m128i *) &PLAY_PATTERN[(i % NUM_PLAYERS) * PLAY_SIZE]);
+
+	__m128i isT = _mm_cmpeq_epi8(v, _mm_set1_epi8('T'));
+	__m128i isV = _mm_cmpeq_epi8(v, _mm_set1_epi8('V'));
+	__m128i isDM = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('D')),
+	                            _mm_cmpeq_epi8(v, _mm_set1_epi8('M')));
+	__m128i isDot = _mm_cmpeq_epi8(v, _mm_set1_epi8('.'));
+	__m128i isEncounter = _mm_or_si128(_mm_or_si128(isT, isV),
+	                                   _mm_or_si128(isDM, isDot));
+
+	__m128i isUpper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)),
+	                                _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+	__m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+	                                _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+	__m128i isAbbrev = _mm_or_si128(_mm_or_si128(isUpper, isDigit),
+	                                _mm_cmpeq_epi8(v, _mm_set1_epi8('?')));
+
+	uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi8(v, pattern));
+	if (!checkBlock(matches, _mm_movemask_epi8(isAbbrev),
+	                _mm_movemask_epi8(isEncounter), 2)) {
+		return false;
+	}
+
+	__m128i codes = _mm_or_si128(
+		_mm_or_si128(_mm_and_si128(isT, _mm_set1_epi8(ENCOUNTER_TRAP)),
+		             _mm_and_si128(isV, _mm_set1_epi8(ENCOUNTER_VAMPIRE))),
+		_mm_and_si128(isDM, _mm_set1_epi8(ENCOUNTER_OTHER)));
+	uint8_t codeBytes[16];
+	_mm_storeu_si128((__m128i *) codeBytes, codes);
+	storeEncounters(buf, codeBytes, i, 2);
+
+	return storeMove(buf, &block[0], i) &&
+	       storeMove(buf, &block[PLAY_SIZE], i + 1);
+}
+
+#endif
+
+#ifdef PLAYS_AVX2
+
+/**
+ * Checks and decodes plays i .. i + 3
+ */
+static bool parseBlockAvx2(TurnBuffer *buf, const char *plays, int i)
+{
+	const char *block = &plays[i * PLAY_SIZE];
+	__m256i v = _mm256_loadu_si256((const __m256i *) block);
+	__m256i pattern = _mm256_loadu_si256(
+		(const __m256i *) &PLAY_PATTERN[(i % NUM_PLAYERS) * PLAY_SIZE]);
+
+	__m256i isT = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('T'));
+	__m256i isV = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('V'));
+	__m256i isDM = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('D')),
+	                               _mm256_cmpeq_epi8(v, _mm256_set1_epi8('M')));
+	__m256i isDot = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'));
+	__m256i isEncounter = _mm256_or_si256(_mm256_or_si256(isT, isV),
+	                                      _mm256_or_si256(isDM, isDot));
+
+	__m256i isUpper = _mm256_and_si256(
+		_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+	__m256i isDigit = _mm256_and_si256(
+		_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+	__m256i isAbbrev = _mm256_or_si256(
+		_mm256_or_si256(isUpper, isDigit),
+		_mm256_cmpeq_epi8(v, _mm256_set1_epi8('?')));
+
+	uint32_t matches = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, pattern));
+	if (!checkBlock(matches, _mm256_movemask_epi8(isAbbrev),
+	                _mm256_movemask_epi8(isEncounter), 4)) {
+		return false;
+	}
+
+	__m256i codes = _mm256_or_si256(
+		_mm256_or_si256(_mm256_and_si256(isT, _mm256_set1_epi8(ENCOUNTER_TRAP)),
+		                _mm256_and_si256(isV, _mm256_set1_epi8(ENCOUNTER_VAMPIRE))),
+		_mm256_and_si256(isDM, _mm256_set1_epi8(ENCOUNTER_OTHER)));
+	uint8_t codeBytes[32];
+	_mm256_storeu_si256((__m256i *) codeBytes, codes);
+	storeEncounters(buf, codeBytes, i, 4);
+
+	for (int p = 0; p < 4; p++) {
+		if (!storeMove(buf, &block[p * PLAY_SIZE], i + p)) return false;
+	}
+	return true;
+}
+
+#endif
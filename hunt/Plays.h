@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Plays.h: a fast parser for pastPlays strings
+//
+// Decodes every play in a pastPlays string into a structure-of-arrays
+// TurnBuffer - one array each of players, moves and encounters - so
+// that a whole game (or many logged games) can be replayed without
+// parsing any play twice. Where the compiler allows it, plays are
+// checked and decoded several at a time with SSE2 or AVX2.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__PLAYS_H_
+#define FOD__PLAYS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Places.h"
+
+// Each play is 7 characters, followed by a space (or the terminator)
+#define PLAY_SIZE 8
+
+/**
+ * A play's encounters are packed 2 bits per character, with the
+ * character at position 3 + i of the play in bits 2i and 2i + 1. Use
+ * playEncounter to get one out.
+ */
+typedef enum encounterCode {
+	ENCOUNTER_NONE    = 0, // '.'
+	ENCOUNTER_TRAP    = 1, // 'T'
+	ENCOUNTER_VAMPIRE = 2, // 'V'
+	ENCOUNTER_OTHER   = 3, // 'D' in a hunter's play, 'M' in Dracula's
+} EncounterCode;
+
+#define PLAY_NUM_ENCOUNTERS 4
+
+static inline EncounterCode playEncounter(uint8_t encounters, int i)
+{
+	return (EncounterCode) ((encounters >> (2 * i)) & 3);
+}
+
+typedef struct turnBuffer {
+	int      numTurns;
+	int      capacity;
+	int8_t  *players;    // Player making each play
+	int8_t  *moves;      // PlaceId of each move (may be a special move)
+	uint8_t *encounters; // packed EncounterCodes of each play
+} TurnBuffer;
+
+/** Initialises an empty buffer. */
+void TurnBufferInit(TurnBuffer *buf);
+
+/** Frees the arrays in a buffer (but not the buffer itself). */
+void TurnBufferFree(TurnBuffer *buf);
+
+/**
+ * Replaces the contents of the buffer with the plays in `pastPlays`,
+ * growing it if needed. Returns false (leaving numTurns at 0) if the
+ * string isn't a well-formed pastPlays string: every play must be made
+ * by the right player in turn, name a real place (or, for Dracula, a
+ * special move) and only use encounter characters that player can.
+ */
+bool TurnBufferParse(TurnBuffer *buf, const char *pastPlays);
+
+/**
+ * Gets the name of the code TurnBufferParse was built to use: "AVX2",
+ * "SSE2" or "scalar".
+ */
+const char *TurnBufferParser(void);
+
+/**
+ * Packs the four encounter characters of one play (e.g. "TD..") into
+ * the form stored in TurnBuffer.encounters.
+ */
+uint8_t playEncodeEncounters(const char *encounters);
+
+#endif // !defined(FOD__PLAYS_H_)
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// Rng.h: small, fast, seedable random number generators
+//
+// An Rng is passed around by pointer to a value the caller owns, so
+// each thread (or each search worker) keeps its own and nothing is
+// shared - unlike rand(), which has one hidden state for the whole
+// process. The generator is splitmix64, which is fast, passes the usual
+// statistical tests, and works with any seed (including 0).
+//
+// The AIs seed theirs with rngTurnSeed, so the same game always plays
+// out the same way; a harness picks a different game by setting
+// FOD_SEED in the environment.
+//
+////////////////////////////////////////////////////////////////////////
+
+#ifndef FOD__RNG_H_
+#define FOD__RNG_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "Game.h"
+
+typedef struct rng {
+	uint64_t state;
+} Rng;
+
+/** Mixes the bits of `x` (the splitmix64 finaliser); 0 stays 0. */
+static inline uint64_t rngMix(uint64_t x)
+{
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/** Gets a generator seeded with `seed`. */
+static inline Rng rngNew(uint64_t seed)
+{
+	return (Rng) { seed };
+}
+
+/** Gets the next 32 random bits from `r`. */
+static inline uint32_t rngNext(Rng *r)
+{
+	return (uint32_t) (rngMix(r->state += 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+/** Gets a random number from 0 to n - 1, where 0 < n. */
+static inline int rngBelow(Rng *r, int n)
+{
+	return (int) (rngNext(r) % (uint32_t) n);
+}
+
+/**
+ * Gets the seed for the given player's turn: different for every turn
+ * of a game, and for every game (the number in FOD_SEED, 0 if unset).
+ */
+static inline uint64_t rngTurnSeed(Round round, Player player)
+{
+	uint64_t game = 0;
+	char *seed = getenv("FOD_SEED");
+	if (seed != NULL) game = strtoull(seed, NULL, 10);
+	return rngMix(game) + (((uint64_t) round << 8) | player);
+}
+
+#endif // !defined(FOD__RNG_H_)
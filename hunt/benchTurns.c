@@ -0,0 +1,323 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// benchTurns.c: how long the AIs take to decide, turn by turn
+//
+// Like player.c, but for every turn of every game in a corpus: every
+// prefix of each game is handed to decideHunterMove or decideDraculaMove
+// (whoever's turn it is), and the time from making the view to the last
+// registerBestPlay is recorded - that is the move the game engine would
+// take. The times are then summarised for each bucket of rounds, and
+// any turn that comes within SLOW_MSECS of the limit is listed.
+//
+// A corpus is a text file with a game on each line that is a pastPlays
+// string; any other line is skipped, as is any game that is a prefix of
+// another (it would just replay the same turns). Dracula's turns are
+// skipped where his moves are hidden, since he always knows where he
+// has been.
+//
+// The AIs take as long as they would in a real game, unless told
+// otherwise through the environment (FOD_TURN_MSECS and so on).
+//
+// Usage: ./benchTurns [-b rounds] [corpus ...]
+//   -b  the number of rounds in each bucket (default 10)
+//   The corpus defaults to ../view/pastPlays.txt.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dracula.h"
+#include "DraculaView.h"
+#include "Game.h"
+#include "hunter.h"
+#include "HunterView.h"
+#include "Plays.h"
+
+// Turns that register their last move this close to the limit are listed
+#define SLOW_MSECS (TURN_LIMIT_MSECS * 9 / 10)
+#define DEFAULT_CORPUS "../view/pastPlays.txt"
+
+typedef struct turn {
+	int game;
+	int numPlays;                    // in the pastPlays it was given
+	Round round;
+	Player player;
+	double msecs;                    // to the last registerBestPlay
+} Turn;
+
+typedef struct turns {
+	Turn *turns;
+	int numTurns;
+	int capacity;
+} Turns;
+
+static struct timespec turnStart;
+static double lastPlayMsecs;
+
+static int readGames(char *path, char ***games, int numGames);
+static bool isPlays(char *line);
+static void playTurn(Turns *t, int game, char *plays, int numPlays);
+static void report(Turns *t, int bucketRounds);
+static double percentile(double *sorted, int n, double p);
+static int compareMsecs(const void *a, const void *b);
+static double msecsSince(struct timespec *start);
+
+int main(int argc, char *argv[])
+{
+	int bucketRounds = 10;
+	int opt;
+	while ((opt = getopt(argc, argv, "b:")) != -1) {
+		switch (opt) {
+			case 'b': bucketRounds = atoi(optarg); break;
+			default:
+				fprintf(stderr, "usage: %s [-b rounds] [corpus ...]\n", argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if (bucketRounds < 1) bucketRounds = 1;
+
+	char **games = NULL;
+	int numGames = 0;
+	if (optind == argc) {
+		numGames = readGames(DEFAULT_CORPUS, &games, numGames);
+	}
+	for (int i = optind; i < argc; i++) {
+		numGames = readGames(argv[i], &games, numGames);
+	}
+
+	Turns t = { NULL, 0, 0 };
+	int numPlayed = 0;
+	for (int g = 0; g < numGames; g++) {
+		// Another game replays all of this one's turns
+		bool covered = false;
+		for (int h = 0; h < numGames && !covered; h++) {
+			size_t length = strlen(games[g]);
+			covered = h != g && strncmp(games[h], games[g], length) == 0 &&
+			          (strlen(games[h]) > length || h < g);
+		}
+		if (covered) continue;
+
+		int numPlays = (strlen(games[g]) + 1) / PLAY_SIZE;
+		for (int n = 0; n <= numPlays; n++) {
+			playTurn(&t, numPlayed, games[g], n);
+		}
+		numPlayed++;
+	}
+
+	printf("%d games, %d turns\n", numPlayed, t.numTurns);
+	report(&t, bucketRounds);
+
+	for (int g = 0; g < numGames; g++) {
+		free(games[g]);
+	}
+	free(games);
+	free(t.turns);
+	return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Reading the corpus
+
+/**
+ * Appends the games in the given file to *games, which holds numGames
+ * games, and returns the new number of games
+ */
+static int readGames(char *path, char ***games, int numGames)
+{
+	FILE *in = fopen(path, "r");
+	if (in == NULL) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t length;
+	while ((length = getline(&line, &size, in)) != -1) {
+		while (length > 0 && (line[length - 1] == '\n' ||
+		                      line[length - 1] == '\r' ||
+		                      line[length - 1] == ' ')) {
+			line[--length] = '\0';
+		}
+		if (!isPlays(line)) continue;
+
+		*games = realloc(*games, (numGames + 1) * sizeof(char *));
+		if (*games == NULL) {
+			fprintf(stderr, "Couldn't allocate games!\n");
+			exit(EXIT_FAILURE);
+		}
+		(*games)[numGames++] = strdup(line);
+	}
+
+	free(line);
+	fclose(in);
+	return numGames;
+}
+
+/**
+ * Checks whether a line is a pastPlays string: plays of the right length
+ * separated by single spaces, each by the player whose turn it is
+ */
+static bool isPlays(char *line)
+{
+	size_t length = strlen(line);
+	if (length == 0 || (length + 1) % PLAY_SIZE != 0) return false;
+	for (size_t i = 0; i < length; i += PLAY_SIZE) {
+		int turn = i / PLAY_SIZE;
+		if (line[i] != "GSHMD"[turn % NUM_PLAYERS]) return false;
+		if (i + PLAY_SIZE - 1 < length && line[i + PLAY_SIZE - 1] != ' ')
+			return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Playing turns
+
+/**
+ * Decides the move for the turn after the first numPlays plays of the
+ * given game, and records how long it took
+ */
+static void playTurn(Turns *t, int game, char *plays, int numPlays)
+{
+	char *pastPlays = strndup(plays, numPlays > 0 ? numPlays * PLAY_SIZE - 1 : 0);
+	if (pastPlays == NULL) {
+		fprintf(stderr, "Couldn't allocate pastPlays!\n");
+		exit(EXIT_FAILURE);
+	}
+	Player player = numPlays % NUM_PLAYERS;
+	if (player == PLAYER_DRACULA && strchr(pastPlays, '?') != NULL) {
+		free(pastPlays);
+		return;
+	}
+
+	lastPlayMsecs = -1;
+	clock_gettime(CLOCK_MONOTONIC, &turnStart);
+	if (player == PLAYER_DRACULA) {
+		DraculaView dv = DvNew(pastPlays, NULL);
+		decideDraculaMove(dv);
+		DvFree(dv);
+	} else {
+		HunterView hv = HvNew(pastPlays, NULL);
+		decideHunterMove(hv);
+		HvFree(hv);
+	}
+	free(pastPlays);
+
+	if (t->numTurns == t->capacity) {
+		t->capacity = t->capacity > 0 ? 2 * t->capacity : 64;
+		t->turns = realloc(t->turns, t->capacity * sizeof(Turn));
+		if (t->turns == NULL) {
+			fprintf(stderr, "Couldn't allocate turns!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// A turn that never registers a move took the whole time
+	double msecs = lastPlayMsecs >= 0 ? lastPlayMsecs : msecsSince(&turnStart);
+	t->turns[t->numTurns++] = (Turn) {
+		.game = game, .numPlays = numPlays,
+		.round = numPlays / NUM_PLAYERS, .player = player, .msecs = msecs,
+	};
+}
+
+// Records when the move was registered; the move itself doesn't matter
+void registerBestPlay(char *play, Message message)
+{
+	lastPlayMsecs = msecsSince(&turnStart);
+}
+
+////////////////////////////////////////////////////////////////////////
+// Reporting
+
+/**
+ * Prints the latency percentiles for the hunters' and Dracula's turns in
+ * each bucket of rounds, then every turn that was too close to the limit
+ */
+static void report(Turns *t, int bucketRounds)
+{
+	Round maxRound = 0;
+	for (int i = 0; i < t->numTurns; i++) {
+		if (t->turns[i].round > maxRound) maxRound = t->turns[i].round;
+	}
+
+	double *msecs = malloc((t->numTurns + 1) * sizeof(double));
+	if (msecs == NULL) {
+		fprintf(stderr, "Couldn't allocate msecs!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("%-8s %-8s %6s %9s %9s %9s %9s\n", "rounds", "player", "turns",
+	       "p50 ms", "p95 ms", "p99 ms", "max ms");
+	for (Round from = 0; from <= maxRound; from += bucketRounds) {
+		for (int side = 0; side < 2; side++) {
+			bool dracula = (side == 1);
+			int n = 0;
+			for (int i = 0; i < t->numTurns; i++) {
+				Turn *turn = &t->turns[i];
+				if (turn->round >= from && turn->round < from + bucketRounds &&
+				    (turn->player == PLAYER_DRACULA) == dracula) {
+					msecs[n++] = turn->msecs;
+				}
+			}
+			if (n == 0) continue;
+
+			qsort(msecs, n, sizeof(double), compareMsecs);
+			char rounds[32];
+			snprintf(rounds, sizeof(rounds), "%d-%d", from, from + bucketRounds - 1);
+			printf("%-8s %-8s %6d %9.1f %9.1f %9.1f %9.1f\n", rounds,
+			       dracula ? "Dracula" : "hunters", n,
+			       percentile(msecs, n, 50), percentile(msecs, n, 95),
+			       percentile(msecs, n, 99), msecs[n - 1]);
+		}
+	}
+	free(msecs);
+
+	int numSlow = 0;
+	for (int i = 0; i < t->numTurns; i++) {
+		Turn *turn = &t->turns[i];
+		if (turn->msecs < SLOW_MSECS) continue;
+		if (numSlow++ == 0) {
+			printf("turns within %dms of the %dms limit:\n",
+			       TURN_LIMIT_MSECS - SLOW_MSECS, TURN_LIMIT_MSECS);
+		}
+		printf("  game %d, after %d plays (round %d, player %d): %.1fms\n",
+		       turn->game, turn->numPlays, turn->round, turn->player,
+		       turn->msecs);
+	}
+	if (numSlow == 0) {
+		printf("no turns within %dms of the %dms limit\n",
+		       TURN_LIMIT_MSECS - SLOW_MSECS, TURN_LIMIT_MSECS);
+	}
+}
+
+/**
+ * Gets the p-th percentile of n sorted times, by the nearest rank
+ */
+static double percentile(double *sorted, int n, double p)
+{
+	int rank = (int) (p / 100 * n + 0.999999);
+	if (rank < 1) rank = 1;
+	if (rank > n) rank = n;
+	return sorted[rank - 1];
+}
+
+static int compareMsecs(const void *a, const void *b)
+{
+	double x = *(const double *) a;
+	double y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+static double msecsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000.0 +
+	       (now.tv_nsec - start->tv_nsec) / 1e6;
+}
@@ -0,0 +1,431 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// benchViews.c: microbenchmarks for the views' and map's hot paths
+//
+// Each benchmark runs one operation over and over, for at least
+// MIN_BENCH_NSECS, and reports the time (from the monotonic clock), the
+// number of allocations and, where the kernel lets us count them, the
+// CPU cycles for each operation. Allocations are counted by wrapping
+// malloc, calloc and realloc at link time (see the Makefile), so only
+// our own code's are counted.
+//
+// The game benchmarked on is played by Match, with the hunters wandering
+// at random (from a fixed seed) but never onto Dracula or his traps, and
+// Dracula going to sea whenever he would place a vampire. So it is the
+// same every time, and lasts until the score runs out, well past the
+// rounds in BENCH_ROUNDS; the views are also benchmarked at its end.
+//
+// Usage: ./benchViews [filter]
+//   Runs only the benchmarks with `filter` in their name, if given.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#include "DraculaView.h"
+#include "Game.h"
+#include "GameView.h"
+#include "HunterView.h"
+#include "Map.h"
+#include "Match.h"
+#include "PlaceSet.h"
+#include "Places.h"
+#include "Plays.h"
+#include "Rng.h"
+
+#define MIN_BENCH_NSECS 200000000L
+
+// The rounds to benchmark the views at, as well as the end of the game
+static Round BENCH_ROUNDS[] = { 0, 50, 150 };
+#define NUM_BENCH_ROUNDS ((int) (sizeof(BENCH_ROUNDS) / sizeof(BENCH_ROUNDS[0])))
+
+// What a benchmark's operation works on
+typedef struct bench {
+	char *pastPlays;
+	TurnBuffer turns;
+	GameView gv;
+	HunterView hv;
+	DraculaView dv;
+	Player player;
+	Round round;
+} Bench;
+
+typedef void (*Op)(Bench *b, long i);
+
+static char *filter = NULL;
+static long numAllocs = 0;
+static int cyclesFd = -1;
+static volatile long sink;
+
+static void playGame(char *plays);
+static PlaceId wander(Match m, Rng *rng);
+static PlaceId lurk(Match m, Rng *rng);
+static char *prefix(char *plays, int numPlays, int n);
+static void run(char *name, Op op, Bench *b);
+static void openCycles(void);
+static uint64_t readCycles(void);
+static long nsecsSince(struct timespec *start);
+
+static void gvNewFree(Bench *b, long i);
+static void turnBufferParse(Bench *b, long i);
+static void gvUpdateFromTurns(Bench *b, long i);
+static void gvGetReachable(Bench *b, long i);
+static void hvNewShortestPath(Bench *b, long i);
+static void hvGetShortestPathTo(Bench *b, long i);
+static void dvGetValidMoves(Bench *b, long i);
+static void mapNewFree(Bench *b, long i);
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1) filter = argv[1];
+	openCycles();
+
+	static char plays[MATCH_PLAYS_SIZE];
+	playGame(plays);
+	int numPlays = (strlen(plays) + 1) / PLAY_SIZE;
+	printf("%-40s %12s %10s %12s\n", "benchmark", "ns/op", "allocs/op",
+	       "cycles/op");
+
+	char name[64];
+	Bench b = { 0 };
+	for (int i = 0; i <= NUM_BENCH_ROUNDS; i++) {
+		int n = numPlays;
+		if (i < NUM_BENCH_ROUNDS) {
+			n = BENCH_ROUNDS[i] * NUM_PLAYERS;
+			snprintf(name, sizeof(name), "GvNew+GvFree round %d", BENCH_ROUNDS[i]);
+		} else {
+			snprintf(name, sizeof(name), "GvNew+GvFree game over (round %d)",
+			         (numPlays - 1) / NUM_PLAYERS);
+		}
+		b.pastPlays = prefix(plays, numPlays, n);
+		run(name, gvNewFree, &b);
+		free(b.pastPlays);
+	}
+
+	// Replaying a game that was parsed once, as a corpus replay would
+	b.pastPlays = prefix(plays, numPlays, numPlays);
+	TurnBufferInit(&b.turns);
+	TurnBufferParse(&b.turns, b.pastPlays);
+	run("TurnBufferParse game over", turnBufferParse, &b);
+	run("GvUpdateFromTurns game over", gvUpdateFromTurns, &b);
+	TurnBufferFree(&b.turns);
+	free(b.pastPlays);
+
+	// The middle of the game, so every player has moved
+	Round round = BENCH_ROUNDS[1];
+	b.pastPlays = prefix(plays, numPlays, round * NUM_PLAYERS);
+	b.gv = GvNew(b.pastPlays, NULL);
+	for (int player = 0; player < NUM_PLAYERS; player++) {
+		for (int phase = 0; phase < 4; phase++) {
+			b.player = player;
+			// The rail phase is (player + round) % 4
+			b.round = round + (phase - (player + round) % 4 + 4) % 4;
+			snprintf(name, sizeof(name), "GvGetReachable player %d phase %d",
+			         player, phase);
+			run(name, gvGetReachable, &b);
+		}
+	}
+	GvFree(b.gv);
+
+	b.hv = HvNew(b.pastPlays, NULL);
+	for (int player = 0; player < PLAYER_DRACULA; player++) {
+		b.player = player;
+		snprintf(name, sizeof(name), "HvNew+HvGetShortestPathTo player %d",
+		         player);
+		run(name, hvNewShortestPath, &b);
+		snprintf(name, sizeof(name), "HvGetShortestPathTo player %d", player);
+		run(name, hvGetShortestPathTo, &b);
+	}
+	HvFree(b.hv);
+	free(b.pastPlays);
+
+	// Dracula's turn in the same round
+	b.pastPlays = prefix(plays, numPlays, round * NUM_PLAYERS + PLAYER_DRACULA);
+	b.dv = DvNew(b.pastPlays, NULL);
+	run("DvGetValidMoves", dvGetValidMoves, &b);
+	DvFree(b.dv);
+	free(b.pastPlays);
+
+	run("MapNew+MapFree", mapNewFree, &b);
+	return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Setting up
+
+/**
+ * Plays a game and writes its real play string to `plays`
+ */
+static void playGame(char *plays)
+{
+	Match m = MatchNew();
+	Rng rng = rngNew(0);
+	while (!MatchIsOver(m)) {
+		if (MatchGetPlayer(m) == PLAYER_DRACULA) {
+			MatchPlay(m, lurk(m, &rng));
+		} else {
+			MatchPlay(m, wander(m, &rng));
+		}
+	}
+	strcpy(plays, MatchGetPlays(m));
+	MatchFree(m);
+}
+
+/**
+ * Picks a random move for the current hunter that doesn't find Dracula
+ * or a trap (or NOWHERE, for the first legal move, if every move does)
+ */
+static PlaceId wander(Match m, Rng *rng)
+{
+	GameView gv = GvNew(MatchGetPlays(m), NULL);
+	Player player = GvGetPlayer(gv);
+	PlaceId from = GvGetPlayerLocation(gv, player);
+	PlaceSet avoid = placeSetOf(GvGetPlayerLocation(gv, PLAYER_DRACULA));
+	int numTraps = 0;
+	PlaceId *traps = GvGetTrapLocations(gv, &numTraps);
+	for (int i = 0; i < numTraps; i++) {
+		avoid = placeSetAdd(avoid, traps[i]);
+	}
+	free(traps);
+
+	PlaceId moves[NUM_REAL_PLACES];
+	int numMoves = 0;
+	if (from == NOWHERE) {
+		moves[numMoves++] = MIN_REAL_PLACE + rngBelow(rng, NUM_REAL_PLACES);
+	} else {
+		GvGetReachableInto(gv, player, GvGetRound(gv), from, moves, &numMoves);
+	}
+	GvFree(gv);
+
+	int numSafe = 0;
+	for (int i = 0; i < numMoves; i++) {
+		if (!placeSetContains(avoid, moves[i])) moves[numSafe++] = moves[i];
+	}
+	return numSafe > 0 ? moves[rngBelow(rng, numSafe)] : NOWHERE;
+}
+
+/**
+ * Picks a random move to sea for Dracula if he would place a vampire
+ * this round, and to land otherwise - Castle Dracula if he can, to get
+ * his blood back (or NOWHERE, for his first legal move)
+ */
+static PlaceId lurk(Match m, Rng *rng)
+{
+	DraculaView dv = DvNew(MatchGetPlays(m), NULL);
+	bool toSea = DvGetRound(dv) % 13 == 0;
+	PlaceId moves[NUM_REAL_PLACES];
+	int numMoves = 0;
+	DvGetValidMovesInto(dv, moves, &numMoves);
+	DvFree(dv);
+
+	int numGood = 0;
+	for (int i = 0; i < numMoves; i++) {
+		if (moves[i] == CASTLE_DRACULA && !toSea) return CASTLE_DRACULA;
+		if (placeIsReal(moves[i]) && placeIsSea(moves[i]) == toSea)
+			moves[numGood++] = moves[i];
+	}
+	return numGood > 0 ? moves[rngBelow(rng, numGood)] : NOWHERE;
+}
+
+/**
+ * Gets a copy of the first `n` plays of `plays`, which has `numPlays`
+ * plays (or all of them, if there aren't that many)
+ */
+static char *prefix(char *plays, int numPlays, int n)
+{
+	if (n > numPlays) n = numPlays;
+	int length = n > 0 ? n * PLAY_SIZE - 1 : 0;
+	char *copy = malloc(length + 1);
+	if (copy == NULL) {
+		fprintf(stderr, "Couldn't allocate prefix!\n");
+		exit(EXIT_FAILURE);
+	}
+	memcpy(copy, plays, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Running benchmarks
+
+/**
+ * Runs `op` enough times to take at least MIN_BENCH_NSECS, and prints
+ * how long each took
+ */
+static void run(char *name, Op op, Bench *b)
+{
+	if (filter != NULL && strstr(name, filter) == NULL) return;
+
+	op(b, 0);                        // warm up
+	long n = 1;
+	while (true) {
+		long allocs = numAllocs;
+		uint64_t cycles = readCycles();
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (long i = 0; i < n; i++) {
+			op(b, i);
+		}
+		long nsecs = nsecsSince(&start);
+		cycles = readCycles() - cycles;
+		allocs = numAllocs - allocs;
+
+		if (nsecs >= MIN_BENCH_NSECS) {
+			printf("%-40s %12.1f %10.2f ", name, (double) nsecs / n,
+			       (double) allocs / n);
+			if (cyclesFd >= 0) {
+				printf("%12.1f\n", (double) cycles / n);
+			} else {
+				printf("%12s\n", "-");
+			}
+			fflush(stdout);
+			return;
+		}
+
+		// Aim a bit past the minimum, so the next run is the last
+		long next = nsecs > 0 ? n * (MIN_BENCH_NSECS * 1.2 / nsecs) : n * 100;
+		n = next > n ? next : n * 2;
+	}
+}
+
+/**
+ * Starts counting this process's CPU cycles, if the kernel lets us
+ */
+static void openCycles(void)
+{
+#ifdef __linux__
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.config = PERF_COUNT_HW_CPU_CYCLES;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	cyclesFd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+	if (cyclesFd < 0) {
+		fprintf(stderr, "(no cycle counter, so no cycles/op)\n");
+	}
+#endif
+}
+
+static uint64_t readCycles(void)
+{
+	uint64_t cycles = 0;
+	if (cyclesFd >= 0 && read(cyclesFd, &cycles, sizeof(cycles)) != sizeof(cycles)) {
+		cycles = 0;
+	}
+	return cycles;
+}
+
+static long nsecsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000000L +
+	       (now.tv_nsec - start->tv_nsec);
+}
+
+// Counts every allocation (see the Makefile)
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	numAllocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+	numAllocs++;
+	return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size)
+{
+	numAllocs++;
+	return __real_realloc(p, size);
+}
+
+////////////////////////////////////////////////////////////////////////
+// The operations
+
+static void gvNewFree(Bench *b, long i)
+{
+	GameView gv = GvNew(b->pastPlays, NULL);
+	sink = GvGetScore(gv);
+	GvFree(gv);
+}
+
+// Into the same buffer each time, so it never has to grow
+static void turnBufferParse(Bench *b, long i)
+{
+	sink = TurnBufferParse(&b->turns, b->pastPlays);
+}
+
+static void gvUpdateFromTurns(Bench *b, long i)
+{
+	GameView gv = GvNew("", NULL);
+	GvUpdateFromTurns(gv, &b->turns);
+	sink = GvGetScore(gv);
+	GvFree(gv);
+}
+
+// From every real place in turn
+static void gvGetReachable(Bench *b, long i)
+{
+	int numLocs = 0;
+	PlaceId from = MIN_REAL_PLACE + i % NUM_REAL_PLACES;
+	PlaceId *locs = GvGetReachable(b->gv, b->player, b->round, from, &numLocs);
+	sink = numLocs;
+	free(locs);
+}
+
+// To every real place in turn, from a new view
+static void hvNewShortestPath(Bench *b, long i)
+{
+	HunterView hv = HvNew(b->pastPlays, NULL);
+	int length = 0;
+	PlaceId dest = MIN_REAL_PLACE + i % NUM_REAL_PLACES;
+	PlaceId *path = HvGetShortestPathTo(hv, b->player, dest, &length);
+	sink = length;
+	free(path);
+	HvFree(hv);
+}
+
+// To every real place in turn, with the same view
+static void hvGetShortestPathTo(Bench *b, long i)
+{
+	int length = 0;
+	PlaceId dest = MIN_REAL_PLACE + i % NUM_REAL_PLACES;
+	PlaceId *path = HvGetShortestPathTo(b->hv, b->player, dest, &length);
+	sink = length;
+	free(path);
+}
+
+static void dvGetValidMoves(Bench *b, long i)
+{
+	int numMoves = 0;
+	PlaceId *moves = DvGetValidMoves(b->dv, &numMoves);
+	sink = numMoves;
+	free(moves);
+}
+
+static void mapNewFree(Bench *b, long i)
+{
+	Map m = MapNew();
+	sink = MapNumPlaces(m);
+	MapFree(m);
+}
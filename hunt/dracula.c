@@ -14,168 +14,487 @@
 #include "dracula.h"
 #include "DraculaView.h"
 #include "Game.h"
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 // Checks whether a hunter can reach a location
-static bool nearby(DraculaView dv, Player hunter, PlaceId dMove);
+static bool nearby(HunterDistances *hd, Player hunter, PlaceId dMove);
 // Checks how many hunters can reach a location
-static int huntersNearby(DraculaView dv, PlaceId dMove);
+static int huntersNearby(HunterDistances *hd, PlaceId dMove);
 // Checks whether a hunter can reach a location in two turns
-static bool reachableInTwoTurns(DraculaView dv, PlaceId location, Player player, Round r);
+static bool reachableInTwoTurns(HunterDistances *hd, PlaceId location, Player player);
 // Decide starting move
-static PlaceId draculaStart(DraculaView dv);
+static PlaceId draculaStart(HunterDistances *hd);
+// Returns the valid move with the highest weight
+static PlaceId bestWeightedMove(DraculaView dv, HunterDistances *hd,
+                                PlaceId *validMoves, int numMoves, int *weight);
+// Weighs up a move for Dracula from the current state
+static int evaluateMove(DraculaView dv, HunterDistances *hd, PlaceId move);
+
+// How much time to leave for everything but the search
+#define SEARCH_MARGIN_MSECS 250
+// How many nodes to search between looking at the clock
+#define SEARCH_CLOCK_INTERVAL 256
+// The deepest search, in Dracula's moves
+#define SEARCH_MAX_DEPTH 12
+// The value of the game being over, and something larger
+#define SEARCH_WIN 1000000
+#define SEARCH_INFINITY 2000000
+// Weights for the state at the end of a search
+#define BLOOD_WEIGHT 10
+#define SCORE_WEIGHT 10
+#define HUNTER_HEALTH_WEIGHT 3
+// The most threads to search with
+#define MAX_THREADS 16
+
+typedef struct search {
+    struct timespec deadline;
+    bool hasDeadline;
+    bool timedOut;
+    long numNodes;
+    int maxDepth;
+} Search;
+
+// Dracula's moves at the root, which the threads take one at a time
+typedef struct rootSearch {
+    pthread_mutex_t lock;
+    int depth;
+    int numMoves;
+    PlaceId moves[NUM_REAL_PLACES];
+    int next;                       // the next move to search
+    int alpha;                      // the best value found so far
+    int values[NUM_REAL_PLACES];
+    bool exact[NUM_REAL_PLACES];    // if values[i] isn't just a bound
+    bool timedOut;
+} RootSearch;
+
+// One thread's part of the search, on its own copy of the view
+typedef struct searchThread {
+    pthread_t thread;
+    bool started;
+    DraculaView dv;
+    Search search;
+    RootSearch *root;
+} SearchThread;
+
+static void startSearch(Search *search);
+static bool outOfTime(Search *search);
+static int gameOverValue(DraculaView dv);
+static int evaluateState(DraculaView dv);
+static int searchDracula(DraculaView dv, Search *search, int depth,
+                         int alpha, int beta);
+static int searchHunters(DraculaView dv, Search *search, int depth,
+                         Player hunter, int alpha, int beta);
+static int searchRoot(SearchThread *threads, int numThreads, RootSearch *root,
+                      int depth, PlaceId *bestMove);
+static void *searchRootMoves(void *arg);
+static int searchThreads(void);
 
 
 void decideDraculaMove(DraculaView dv)
 {
+    Search search;
+    startSearch(&search);
+
     PlaceId draculaMove = TELEPORT;
-    // Extract information
-    int draculaHealth = DvGetHealth(dv, PLAYER_DRACULA);
-    PlaceId currentLocation = DvGetPlayerLocation(dv, PLAYER_DRACULA);
     int numMoves = 0;
-    PlaceId *validMoves = DvGetValidMoves(dv, &numMoves);
-    Round round = DvGetRound(dv);
+    PlaceId validMoves[NUM_REAL_PLACES];
+    DvGetValidMovesInto(dv, validMoves, &numMoves);
+    // Every hunter's distance to every place, for the weights below
+    HunterDistances hd;
+    DvGetHunterDistances(dv, &hd);
     
     // Hasn't gone yet
     if (numMoves == 0 && DvGetPlayerLocation(dv, PLAYER_DRACULA) == NOWHERE) {
-        draculaMove = draculaStart(dv);
+        draculaMove = draculaStart(&hd);
         registerBestPlay((char *)placeIdToAbbrev(draculaMove), "JAWA - we don't go by the script");
-        free(validMoves);
         return;
     // Teleport as only move
     } else if (numMoves == 0) {
         registerBestPlay((char *)placeIdToAbbrev(draculaMove), "JAWA - we don't go by the script");
-        free(validMoves);
         return;
     }
 
-    // Higher moveWeight is preferred
-    int moveWeight[NUM_REAL_PLACES] = {0};
-    // For each valid move
-    for (int i = 0; i < numMoves; i++) {
-        PlaceId move = validMoves[i];
-        PlaceId location = move;
-        // HIDE move
-        if (move == HIDE) location = currentLocation;
-        // DOUBLE_BACK move
-        else if (!placeIsReal(move)) location = resolveDoubleBack(dv, move);
-
-        // Weight 1: Number of hunters that can reach that location
-        int numHunters = huntersNearby(dv, location);
-        moveWeight[i] -= 50 * numHunters;
-
-        // Extra weighting if hunter already at location
-        for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
-            if (DvGetPlayerLocation(dv, player) == location && !placeIsSea(location))
-                moveWeight[i] -= 120;
+    // Start with the move the weights like best, so there's always one
+    // registered
+    draculaMove = bestWeightedMove(dv, &hd, validMoves, numMoves, NULL);
+    registerBestPlay((char *)placeIdToAbbrev(draculaMove), "JAWA - we don't go by the script");
+    if (numMoves == 1) return;
 
-        // Reachable within two turns
-        int numHuntersNotReachable = 0;
-        for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++) {
-            if (!reachableInTwoTurns(dv, location, player, round))
-                numHuntersNotReachable++;
+    // Then look further ahead each time, until we run out of time, with
+    // every thread searching its own share of the moves
+    RootSearch root;
+    pthread_mutex_init(&root.lock, NULL);
+    root.numMoves = numMoves;
+    int numThreads = searchThreads();
+    SearchThread threads[MAX_THREADS];
+    for (int i = 0; i < numThreads; i++) {
+        threads[i].dv = (i == 0 ? dv : DvClone(dv));
+        threads[i].search = search;
+        threads[i].root = &root;
+    }
+
+    for (int depth = 1; depth <= search.maxDepth; depth++) {
+        PlaceId move = draculaMove;
+        for (int i = 0; i < numMoves; i++) root.moves[i] = validMoves[i];
+        int value = searchRoot(threads, numThreads, &root, depth, &move);
+        if (root.timedOut) break;
+
+        draculaMove = move;
+        registerBestPlay((char *)placeIdToAbbrev(draculaMove), "JAWA - we don't go by the script");
+        // No point looking further if the outcome is already decided
+        if (value <= -SEARCH_WIN || value >= SEARCH_WIN) break;
+    }
+
+    for (int i = 1; i < numThreads; i++) DvFree(threads[i].dv);
+    pthread_mutex_destroy(&root.lock);
+}
+
+// Returns the valid move with the highest weight (the first, if several
+// are as high), and sets *weight to its weight if it isn't NULL
+static PlaceId bestWeightedMove(DraculaView dv, HunterDistances *hd,
+                                PlaceId *validMoves, int numMoves, int *weight)
+{
+    int maxIndex = 0; int maxWeight = evaluateMove(dv, hd, validMoves[0]);
+    for (int i = 1; i < numMoves; i++) {
+        int moveWeight = evaluateMove(dv, hd, validMoves[i]);
+        if (moveWeight > maxWeight) {
+            maxIndex = i; maxWeight = moveWeight;
         }
-        moveWeight[i] += 15 * numHuntersNotReachable;
-
-        // Check death condition
-        if (draculaHealth <= numHunters * LIFE_LOSS_HUNTER_ENCOUNTER + (placeIsSea(location) * 2) &&
-            location != CASTLE_DRACULA)
-            moveWeight[i] -= 100000;
-
-        // Weight 2: Type of move
-        if (!placeIsReal(move)) moveWeight[i] -= 2;
-        if (placeIsSea(location)) moveWeight[i] -= 1;
-
-        if (draculaHealth <= 20 && placeIsSea(location)) moveWeight[i] -= 5;      
-        if (draculaHealth <= 10 && placeIsSea(location)) moveWeight[i] -= 5;
-        if (draculaHealth <= 5 && placeIsSea(location)) moveWeight[i] -= 5;
-        
-        // Prefers to go to sea if encountered hunter
+    }
+    if (weight != NULL) *weight = maxWeight;
+    return validMoves[maxIndex];
+}
+
+// Weighs up a move for Dracula from the current state: higher is better
+static int evaluateMove(DraculaView dv, HunterDistances *hd, PlaceId move)
+{
+    int draculaHealth = DvGetHealth(dv, PLAYER_DRACULA);
+    PlaceId currentLocation = DvGetPlayerLocation(dv, PLAYER_DRACULA);
+    int weight = 0;
+
+    PlaceId location = move;
+    // HIDE move
+    if (move == HIDE) location = currentLocation;
+    // DOUBLE_BACK move
+    else if (!placeIsReal(move)) location = resolveDoubleBack(dv, move);
+
+    // Weight 1: Number of hunters that can reach that location
+    int numHunters = huntersNearby(hd, location);
+    weight -= 50 * numHunters;
+
+    // Extra weighting if hunter already at location
+    for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
+        if (DvGetPlayerLocation(dv, player) == location && !placeIsSea(location))
+            weight -= 120;
+
+    // Reachable within two turns
+    int numHuntersNotReachable = 0;
+    for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++) {
+        if (!reachableInTwoTurns(hd, location, player))
+            numHuntersNotReachable++;
+    }
+    weight += 15 * numHuntersNotReachable;
+
+    // Check death condition
+    if (draculaHealth <= numHunters * LIFE_LOSS_HUNTER_ENCOUNTER + (placeIsSea(location) * 2) &&
+        location != CASTLE_DRACULA)
+        weight -= 100000;
+
+    // Weight 2: Type of move
+    if (!placeIsReal(move)) weight -= 2;
+    if (placeIsSea(location)) weight -= 1;
+
+    if (draculaHealth <= 20 && placeIsSea(location)) weight -= 5;      
+    if (draculaHealth <= 10 && placeIsSea(location)) weight -= 5;
+    if (draculaHealth <= 5 && placeIsSea(location)) weight -= 5;
+    
+    // Prefers to go to sea if encountered hunter
+    for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
+        if (DvGetPlayerLocation(dv, player) == currentLocation && placeIsSea(location))
+            weight += 5;
+
+    // Prefers to go to CD
+    int huntersNotReachable = 0;
+    if (location == CASTLE_DRACULA)  {
+        weight += 7;
         for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
-            if (DvGetPlayerLocation(dv, player) == currentLocation && placeIsSea(location))
-                moveWeight[i] += 5;
-
-        // Prefers to go to CD
-        int huntersNotReachable = 0;
-        if (location == CASTLE_DRACULA)  {
-            moveWeight[i] += 7;
-            for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
-                if (!reachableInTwoTurns(dv, location, player, round)) huntersNotReachable++;
-        }
-        
-        if (location == CASTLE_DRACULA && huntersNotReachable > 1) moveWeight[i] += 85;
+            if (!reachableInTwoTurns(hd, location, player)) huntersNotReachable++;
+    }
+    
+    if (location == CASTLE_DRACULA && huntersNotReachable > 1) weight += 85;
+
+    // Avoid staying at CD
+    if (!placeIsReal(move) && location == CASTLE_DRACULA && draculaHealth >= 30) weight -= 50;
+    if (!placeIsReal(move) && location == CASTLE_DRACULA && draculaHealth >= 20) weight -= 30; 
 
-        // Avoid staying at CD
-        if (!placeIsReal(move) && location == CASTLE_DRACULA && draculaHealth >= 30) moveWeight[i] -= 50;
-        if (!placeIsReal(move) && location == CASTLE_DRACULA && draculaHealth >= 20) moveWeight[i] -= 30; 
+    // Prevent looping - move away
+    if (currentLocation == IONIAN_SEA && (location == TYRRHENIAN_SEA || location == ADRIATIC_SEA))
+        weight += 15;
+
+    return weight;
+}
 
-        // Prevent looping - move away
-        if (currentLocation == IONIAN_SEA && (location == TYRRHENIAN_SEA || location == ADRIATIC_SEA))
-            moveWeight[i] += 15;
+////////////////////////////////////////////////////////////////////////
+// Searching ahead
+//
+// A paranoid alpha-beta search: Dracula picks the move that's best for
+// him assuming the hunters, who all know where he is, then pick the
+// replies that are worst for him. To keep the tree small, each hunter
+// only considers stepping towards him or staying put. The search runs
+// to deeper and deeper depths (counted in Dracula's moves) until a
+// deadline on the monotonic clock, and the move from the deepest search
+// that finished is the one registered.
+//
+// FOD_TURN_MSECS in the environment overrides how long a turn can take,
+// and FOD_SEARCH_DEPTH searches to exactly that depth with no deadline,
+// so the moves chosen don't depend on how fast the machine is (though
+// with more than one thread, which of two equally good moves is chosen
+// can). FOD_THREADS sets the number of threads.
+
+static void startSearch(Search *search)
+{
+    clock_gettime(CLOCK_MONOTONIC, &search->deadline);
+    search->hasDeadline = true;
+    search->timedOut = false;
+    search->numNodes = 0;
+    search->maxDepth = SEARCH_MAX_DEPTH;
+
+    long msecs = TURN_LIMIT_MSECS - SEARCH_MARGIN_MSECS;
+    char *turnMsecs = getenv("FOD_TURN_MSECS");
+    if (turnMsecs != NULL) msecs = atol(turnMsecs) - SEARCH_MARGIN_MSECS;
+    char *searchDepth = getenv("FOD_SEARCH_DEPTH");
+    if (searchDepth != NULL) {
+        search->hasDeadline = false;
+        search->maxDepth = atoi(searchDepth);
     }
 
-    // Select max weight
-    int maxIndex = 0; int maxWeight = moveWeight[0];
-    for (int i = 1; i < numMoves; i++) {
-        if (moveWeight[i] > maxWeight) {
-            maxIndex = i; maxWeight = moveWeight[i];
+    if (msecs < 0) msecs = 0;
+    search->deadline.tv_sec += msecs / 1000;
+    search->deadline.tv_nsec += (msecs % 1000) * 1000000;
+    if (search->deadline.tv_nsec >= 1000000000) {
+        search->deadline.tv_sec++;
+        search->deadline.tv_nsec -= 1000000000;
+    }
+}
+
+// Checks the clock every so often; once time is up, it stays up
+static bool outOfTime(Search *search)
+{
+    if (search->timedOut) return true;
+    if (!search->hasDeadline || ++search->numNodes % SEARCH_CLOCK_INTERVAL != 0)
+        return false;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > search->deadline.tv_sec ||
+        (now.tv_sec == search->deadline.tv_sec && now.tv_nsec >= search->deadline.tv_nsec))
+        search->timedOut = true;
+    return search->timedOut;
+}
+
+// Returns the value of the game for Dracula if it's over, or 0
+static int gameOverValue(DraculaView dv)
+{
+    if (DvGetHealth(dv, PLAYER_DRACULA) <= 0) return -SEARCH_WIN;
+    if (DvGetScore(dv) <= 0) return SEARCH_WIN;
+    return 0;
+}
+
+// Values a state where it's Dracula's turn, by his best weighted move,
+// his blood and the score
+static int evaluateState(DraculaView dv)
+{
+    int numMoves = 0;
+    PlaceId validMoves[NUM_REAL_PLACES];
+    DvGetValidMovesInto(dv, validMoves, &numMoves);
+    int weight = 0;
+    if (numMoves > 0) {
+        HunterDistances hd;
+        DvGetHunterDistances(dv, &hd);
+        bestWeightedMove(dv, &hd, validMoves, numMoves, &weight);
+    }
+
+    int hunterHealth = 0;
+    for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
+        hunterHealth += DvGetHealth(dv, player);
+
+    return weight + BLOOD_WEIGHT * DvGetHealth(dv, PLAYER_DRACULA)
+         - SCORE_WEIGHT * DvGetScore(dv) - HUNTER_HEALTH_WEIGHT * hunterHealth;
+}
+
+// Searches Dracula's moves to the given depth
+static int searchDracula(DraculaView dv, Search *search, int depth,
+                         int alpha, int beta)
+{
+    int over = gameOverValue(dv);
+    if (over != 0) return over;
+    if (depth == 0) return evaluateState(dv);
+
+    int numMoves = 0;
+    PlaceId validMoves[NUM_REAL_PLACES];
+    DvGetValidMovesInto(dv, validMoves, &numMoves);
+    if (numMoves == 0) validMoves[numMoves++] = TELEPORT;
+
+    int best = -SEARCH_INFINITY;
+    for (int i = 0; i < numMoves; i++) {
+        GvUndo undo;
+        DvApplyMove(dv, PLAYER_DRACULA, validMoves[i], &undo);
+        int value = searchHunters(dv, search, depth, PLAYER_LORD_GODALMING, alpha, beta);
+        DvUndoMove(dv, PLAYER_DRACULA, &undo);
+        if (outOfTime(search)) return 0;
+
+        if (value > best) best = value;
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+// Searches each of Dracula's moves at the root to the given depth, on
+// all the threads at once, and sets *bestMove to the best one. The best
+// move from the last search is searched first, since it's most likely
+// the best again. Each thread takes the next move that nobody has
+// started on, and only needs to beat the best value found so far by any
+// thread - so with one thread, this is just searchDracula.
+static int searchRoot(SearchThread *threads, int numThreads, RootSearch *root,
+                      int depth, PlaceId *bestMove)
+{
+    for (int i = 1; i < root->numMoves; i++) {
+        if (root->moves[i] == *bestMove) {
+            root->moves[i] = root->moves[0];
+            root->moves[0] = *bestMove;
+            break;
         }
     }
-    draculaMove = validMoves[maxIndex];
-    registerBestPlay((char *)placeIdToAbbrev(draculaMove), "JAWA - we don't go by the script");
-    free(validMoves);
+    root->depth = depth;
+    root->next = 0;
+    root->alpha = -SEARCH_INFINITY;
+    root->timedOut = false;
+
+    for (int i = 1; i < numThreads; i++) {
+        threads[i].started = pthread_create(&threads[i].thread, NULL,
+                                            searchRootMoves, &threads[i]) == 0;
+    }
+    searchRootMoves(&threads[0]);
+    for (int i = 1; i < numThreads; i++) {
+        if (threads[i].started) pthread_join(threads[i].thread, NULL);
+    }
+    if (root->timedOut) return 0;
+
+    // Moves that only matched the best so far might be worse, so only
+    // exact values count; ties go to the move searched first
+    int best = -SEARCH_INFINITY;
+    for (int i = 0; i < root->numMoves; i++) {
+        if (root->exact[i] && root->values[i] > best) {
+            best = root->values[i];
+            *bestMove = root->moves[i];
+        }
+    }
+    return best;
 }
 
+static void *searchRootMoves(void *arg)
+{
+    SearchThread *t = arg;
+    RootSearch *root = t->root;
+    while (true) {
+        pthread_mutex_lock(&root->lock);
+        if (root->timedOut || root->next == root->numMoves) {
+            pthread_mutex_unlock(&root->lock);
+            return NULL;
+        }
+        int i = root->next++;
+        int alpha = root->alpha;
+        pthread_mutex_unlock(&root->lock);
+
+        GvUndo undo;
+        DvApplyMove(t->dv, PLAYER_DRACULA, root->moves[i], &undo);
+        int value = searchHunters(t->dv, &t->search, root->depth,
+                                  PLAYER_LORD_GODALMING, alpha, SEARCH_INFINITY);
+        DvUndoMove(t->dv, PLAYER_DRACULA, &undo);
 
-// Checks whether a hunter can reach a location
-static bool nearby(DraculaView dv, Player hunter, PlaceId dMove)
-{
-    int numReturnedLocs = 0;
-    PlaceId *hunterConnections = DvWhereCanTheyGo(dv, hunter, &numReturnedLocs);
-    for (int i = 0; i < numReturnedLocs; i++) {
-        if (hunterConnections[i] == dMove) {
-            free(hunterConnections);
-            return true;
+        // Only a search that was cut short loses the depth: asking the
+        // clock again here could throw away a move that finished in time
+        pthread_mutex_lock(&root->lock);
+        if (t->search.timedOut) {
+            root->timedOut = true;
+        } else {
+            root->values[i] = value;
+            root->exact[i] = value > alpha;
+            if (value > root->alpha) root->alpha = value;
         }
+        pthread_mutex_unlock(&root->lock);
     }
-    free(hunterConnections);
-    return false;
+}
+
+// Gets how many threads to search with: FOD_THREADS if it's set, or
+// else one for each core
+static int searchThreads(void)
+{
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    char *threads = getenv("FOD_THREADS");
+    if (threads != NULL) numThreads = atol(threads);
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    return numThreads;
+}
+
+// Searches the replies of the given hunter and the ones after them
+static int searchHunters(DraculaView dv, Search *search, int depth,
+                         Player hunter, int alpha, int beta)
+{
+    int over = gameOverValue(dv);
+    if (over != 0) return over;
+    if (hunter == PLAYER_DRACULA)
+        return searchDracula(dv, search, depth - 1, alpha, beta);
+
+    // Chase Dracula, or stay put
+    PlaceId location = DvGetPlayerLocation(dv, hunter);
+    PlaceId moves[2] = { DvGetNextStep(dv, hunter, DvGetPlayerLocation(dv, PLAYER_DRACULA)), location };
+    int numMoves = (moves[0] == location ? 1 : 2);
+
+    int best = SEARCH_INFINITY;
+    for (int i = 0; i < numMoves; i++) {
+        GvUndo undo;
+        DvApplyMove(dv, hunter, moves[i], &undo);
+        int value = searchHunters(dv, search, depth, hunter + 1, alpha, beta);
+        DvUndoMove(dv, hunter, &undo);
+        if (outOfTime(search)) return 0;
+
+        if (value < best) best = value;
+        if (best < beta) beta = best;
+        if (alpha >= beta) break;
+    }
+    return best;
+}
+
+// Checks whether a hunter can reach a location
+static bool nearby(HunterDistances *hd, Player hunter, PlaceId dMove)
+{
+    return hd->dist[hunter][dMove] <= 1;
 }
 
 // Checks how many hunters can reach a location
-static int huntersNearby(DraculaView dv, PlaceId dMove)
+static int huntersNearby(HunterDistances *hd, PlaceId dMove)
 {
     int hunters = 0;
     for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++)
-        if (nearby(dv, player, dMove)) hunters++;
+        if (nearby(hd, player, dMove)) hunters++;
     return hunters;
 }
 
 // Checks whether a hunter can reach a location in two turns
-static bool reachableInTwoTurns(DraculaView dv, PlaceId location, Player player, Round r)
-{
-    int firstOrderLocs = 0;
-    PlaceId *firstOrderReachable = DvGetReachable(dv, player, r+1, DvGetPlayerLocation(dv, player),
-                                                  &firstOrderLocs);
-    for (int i = 0; i < firstOrderLocs; i++) {
-        int secondOrderLocs = 0;
-        PlaceId *secondOrderReachable = DvGetReachable(dv, player, r+2, firstOrderReachable[i],
-                                                       &secondOrderLocs);
-        for (int j = 0; j < secondOrderLocs; j++) {
-            if (firstOrderReachable[i] == location || secondOrderReachable[j] == location) {
-                free(firstOrderReachable);
-                free(secondOrderReachable);
-                return true;
-            }
-        }
-        free(secondOrderReachable);
-    }
-    free(firstOrderReachable);
-    return false;
+static bool reachableInTwoTurns(HunterDistances *hd, PlaceId location, Player player)
+{
+    return hd->dist[player][location] <= 2;
 }
 
 // Decide starting move
-static PlaceId draculaStart(DraculaView dv)
+static PlaceId draculaStart(HunterDistances *hd)
 {
     // Process options, weighted by the number of hunters that can reach that location
     PlaceId options[4] = {CASTLE_DRACULA, ATHENS, DUBLIN, HAMBURG};
@@ -183,8 +502,8 @@ static PlaceId draculaStart(DraculaView dv)
     for (int i = 0; i < 4; i++) {
         PlaceId option = options[i];
         for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++) {
-            if (!nearby(dv, player, option))
-                weight[i] += huntersNearby(dv, option);
+            if (!nearby(hd, player, option))
+                weight[i] += huntersNearby(hd, option);
         }
     }
     // If all starting options are reachable - select min of weights
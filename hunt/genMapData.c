@@ -0,0 +1,544 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// genMapData.c: generates MapData.c, the read-only map tables
+//
+// Run at build time (see the Makefile):
+//     ./genMapData > MapData.c
+//
+// Reads the PLACES and CONNECTIONS tables from Places.c, removes
+// duplicate connections, and prints C definitions of the tables
+// declared in MapData.h, so that building the map costs nothing at
+// run time.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "MapData.h"
+#include "Places.h"
+
+// No place has anywhere near this many connections of one type
+#define MAX_DEGREE 32
+
+#define UNREACHABLE 255
+
+typedef struct adjacency {
+	PlaceId places[NUM_REAL_PLACES][MAP_NUM_TRANSPORTS][MAX_DEGREE];
+	int     degree[NUM_REAL_PLACES][MAP_NUM_TRANSPORTS];
+	int     numConnections;
+} Adjacency;
+
+static void readConnections(Adjacency *adj);
+static void addConnection(Adjacency *adj, PlaceId v, PlaceId w,
+                          TransportType type);
+static bool adjacencyContains(Adjacency *adj, PlaceId v, PlaceId w,
+                              TransportType type);
+static bool isSentinelEdge(Connection c);
+
+static void printHeader(void);
+static void printEdges(Adjacency *adj);
+static void printConnNodes(Adjacency *adj);
+static void printPlaces(void);
+static void printAbbrevIds(void);
+
+static void hunterMoves(Adjacency *adj, PlaceId from, int railHops,
+                        bool moves[NUM_REAL_PLACES]);
+static void addRailMoves(Adjacency *adj, PlaceId from, int railHops,
+                         bool moves[NUM_REAL_PLACES]);
+static void hunterBfs(Adjacency *adj, PlaceId src, int railPhase,
+                      int dist[NUM_REAL_PLACES],
+                      PlaceId firstStep[NUM_REAL_PLACES]);
+static void printHunterDistances(Adjacency *adj);
+static void printDraculaMoves(Adjacency *adj);
+
+static void printPlaceSet(bool places[NUM_REAL_PLACES]);
+static void printMasks(Adjacency *adj);
+
+static uint64_t nextZobristKey(void);
+static void printZobristRow(int numKeys, bool zero);
+static void printZobristTable(const char *decl, int numRows, int numKeys,
+                              bool firstRowIsZero);
+static void printZobristKeys(void);
+
+int main(void)
+{
+	static Adjacency adj;
+	readConnections(&adj);
+
+	printHeader();
+	printEdges(&adj);
+	printConnNodes(&adj);
+	printPlaces();
+	printAbbrevIds();
+	printMasks(&adj);
+	printHunterDistances(&adj);
+	printDraculaMoves(&adj);
+	printZobristKeys();
+	return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+/// Add every connection in CONNECTIONS (in both directions)
+static void readConnections(Adjacency *adj)
+{
+	for (int i = 0; !isSentinelEdge(CONNECTIONS[i]); i++) {
+		addConnection(adj, CONNECTIONS[i].v, CONNECTIONS[i].w,
+		              CONNECTIONS[i].t);
+	}
+}
+
+static void addConnection(Adjacency *adj, PlaceId v, PlaceId w,
+                          TransportType type)
+{
+	assert(v != w);
+	assert(placeIsReal(v));
+	assert(placeIsReal(w));
+	assert(transportTypeIsValid(type));
+
+	// don't add edges twice
+	if (adjacencyContains(adj, v, w, type)) return;
+
+	int t = type - MIN_TRANSPORT;
+	assert(adj->degree[v][t] < MAX_DEGREE);
+	assert(adj->degree[w][t] < MAX_DEGREE);
+	adj->places[v][t][adj->degree[v][t]++] = w;
+	adj->places[w][t][adj->degree[w][t]++] = v;
+	adj->numConnections++;
+}
+
+static bool adjacencyContains(Adjacency *adj, PlaceId v, PlaceId w,
+                              TransportType type)
+{
+	int t = type - MIN_TRANSPORT;
+	for (int i = 0; i < adj->degree[v][t]; i++) {
+		if (adj->places[v][t][i] == w) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Is this the magic 'sentinel' edge?
+static bool isSentinelEdge(Connection c)
+{
+	return c.v == -1 && c.w == -1 && c.t == ANY;
+}
+
+////////////////////////////////////////////////////////////////////////
+
+static void printHeader(void)
+{
+	printf("// MapData.c: generated by genMapData - DO NOT EDIT\n\n");
+	printf("#include <stdlib.h>\n\n");
+	printf("#include \"Map.h\"\n");
+	printf("#include \"MapData.h\"\n");
+	printf("#include \"Places.h\"\n\n");
+}
+
+static void printEdges(Adjacency *adj)
+{
+	printf("const int MAP_NUM_CONNECTIONS = %d;\n\n", adj->numConnections);
+
+	printf("const int MAP_EDGE_START[NUM_REAL_PLACES * MAP_NUM_TRANSPORTS + 1] = {\n");
+	int numEdges = 0;
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		printf("\t");
+		for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+			printf("%4d,", numEdges);
+			numEdges += adj->degree[p][t];
+		}
+		printf(" // %s\n", PLACES[p].abbrev);
+	}
+	printf("\t%4d,\n};\n\n", numEdges);
+
+	printf("const PlaceId MAP_EDGES[] = {\n");
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+			if (adj->degree[p][t] == 0) continue;
+			printf("\t");
+			for (int i = 0; i < adj->degree[p][t]; i++) {
+				printf("%2d, ", adj->places[p][t][i]);
+			}
+			printf("// %s by %s\n", PLACES[p].abbrev,
+			       transportTypeToString(t + MIN_TRANSPORT));
+		}
+	}
+	printf("};\n\n");
+}
+
+static void printConnNodes(Adjacency *adj)
+{
+	printf("const struct connNode MAP_CONN_NODES[] = {\n");
+	int node = 0;
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		int degree = 0;
+		for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+			degree += adj->degree[p][t];
+		}
+
+		int n = 0;
+		for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+			for (int i = 0; i < adj->degree[p][t]; i++, n++, node++) {
+				printf("\t{%2d, %s, ", adj->places[p][t][i],
+				       t + MIN_TRANSPORT == ROAD ? "ROAD" :
+				       t + MIN_TRANSPORT == RAIL ? "RAIL" : "BOAT");
+				if (n + 1 < degree) {
+					printf("(ConnList) &MAP_CONN_NODES[%d]},\n", node + 1);
+				} else {
+					printf("NULL},\n");
+				}
+			}
+		}
+	}
+	printf("};\n\n");
+}
+
+static void printPlaces(void)
+{
+	printf("const PlaceType MAP_PLACE_TYPES[NUM_REAL_PLACES] = {\n");
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		printf("\t%s, // %s\n", PLACES[p].type == SEA ? "SEA" : "LAND",
+		       PLACES[p].abbrev);
+	}
+	printf("};\n\n");
+
+	printf("const char MAP_PLACE_ABBREVS[NUM_REAL_PLACES][3] = {\n");
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		printf("\t\"%s\",\n", PLACES[p].abbrev);
+	}
+	printf("};\n");
+}
+
+/// Every abbreviation that can appear in a play string
+static const char *SPECIAL_ABBREVS[] = {
+	"C?", "S?", "HI", "D1", "D2", "D3", "D4", "D5", "TP",
+};
+
+static void printAbbrevIds(void)
+{
+	static signed char ids[64 * 64];
+	for (int i = 0; i < 64 * 64; i++) {
+		ids[i] = NOWHERE;
+	}
+
+	int numSpecial = sizeof(SPECIAL_ABBREVS) / sizeof(SPECIAL_ABBREVS[0]);
+	for (int i = 0; i < NUM_REAL_PLACES + numSpecial; i++) {
+		const char *abbrev = (i < NUM_REAL_PLACES ? PLACES[i].abbrev :
+		                      SPECIAL_ABBREVS[i - NUM_REAL_PLACES]);
+		int index = MAP_ABBREV_INDEX(abbrev[0], abbrev[1]);
+		assert(ids[index] == NOWHERE); // no two abbreviations collide
+		ids[index] = placeAbbrevToId((char *) abbrev);
+	}
+
+	// One row for each value of the first character's low 6 bits
+	printf("\nconst signed char MAP_ABBREV_IDS[64 * 64] = {\n");
+	for (int c0 = 0; c0 < 64; c0++) {
+		printf("\t");
+		for (int c1 = 0; c1 < 64; c1++) {
+			printf("%d,", ids[(c0 << 6) | c1]);
+		}
+		printf("\n");
+	}
+	printf("};\n");
+}
+
+////////////////////////////////////////////////////////////////////////
+// Masks
+
+/// Prints an initialiser for the PlaceSet containing the places p for
+/// which places[p] is true
+static void printPlaceSet(bool places[NUM_REAL_PLACES])
+{
+	unsigned long long words[PLACE_SET_WORDS] = {0};
+	for (int i = 0; i < NUM_REAL_PLACES; i++) {
+		if (places[i]) {
+			words[i / 64] |= 1ULL << (i % 64);
+		}
+	}
+
+	printf("{ {");
+	for (int w = 0; w < PLACE_SET_WORDS; w++) {
+		printf(" 0x%016llxULL,", words[w]);
+	}
+	printf(" } }");
+}
+
+static void printMasks(Adjacency *adj)
+{
+	bool places[NUM_REAL_PLACES];
+
+	for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+		if (t + MIN_TRANSPORT == RAIL) continue;
+		printf("\nconst PlaceSet MAP_%s_MASK[NUM_REAL_PLACES] = {\n",
+		       t + MIN_TRANSPORT == ROAD ? "ROAD" : "BOAT");
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			for (int i = 0; i < NUM_REAL_PLACES; i++) {
+				places[i] = false;
+			}
+			for (int i = 0; i < adj->degree[p][t]; i++) {
+				places[adj->places[p][t][i]] = true;
+			}
+			printf("\t");
+			printPlaceSet(places);
+			printf(", // %s\n", PLACES[p].abbrev);
+		}
+		printf("};\n");
+	}
+
+	printf("\nconst PlaceSet MAP_RAIL_MASK"
+	       "[MAP_MAX_RAIL_HOPS + 1][NUM_REAL_PLACES] = {\n");
+	for (int hops = 0; hops <= MAP_MAX_RAIL_HOPS; hops++) {
+		printf("\t{ // up to %d hops\n", hops);
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			for (int i = 0; i < NUM_REAL_PLACES; i++) {
+				places[i] = false;
+			}
+			addRailMoves(adj, p, hops, places);
+			printf("\t\t");
+			printPlaceSet(places);
+			printf(", // %s\n", PLACES[p].abbrev);
+		}
+		printf("\t},\n");
+	}
+	printf("};\n");
+
+	printf("\nconst PlaceSet MAP_TYPE_MASK[SEA + 1] = {\n");
+	for (PlaceType type = UNKNOWN; type <= SEA; type++) {
+		for (int i = 0; i < NUM_REAL_PLACES; i++) {
+			places[i] = (PLACES[i].type == type);
+		}
+		printf("\t");
+		printPlaceSet(places);
+		printf(", // %s\n", type == LAND ? "LAND" :
+		                     type == SEA ? "SEA" : "UNKNOWN");
+	}
+	printf("};\n");
+}
+
+////////////////////////////////////////////////////////////////////////
+// Hunter distances
+
+/// Sets moves[p] for every place a hunter at `from` can move to, if
+/// they can travel up to `railHops` stations by rail
+static void hunterMoves(Adjacency *adj, PlaceId from, int railHops,
+                        bool moves[NUM_REAL_PLACES])
+{
+	for (int i = 0; i < NUM_REAL_PLACES; i++) {
+		moves[i] = false;
+	}
+	moves[from] = true;
+
+	int road = ROAD - MIN_TRANSPORT;
+	int boat = BOAT - MIN_TRANSPORT;
+	for (int i = 0; i < adj->degree[from][road]; i++) {
+		moves[adj->places[from][road][i]] = true;
+	}
+	for (int i = 0; i < adj->degree[from][boat]; i++) {
+		moves[adj->places[from][boat][i]] = true;
+	}
+	addRailMoves(adj, from, railHops, moves);
+}
+
+static void addRailMoves(Adjacency *adj, PlaceId from, int railHops,
+                         bool moves[NUM_REAL_PLACES])
+{
+	moves[from] = true;
+	if (railHops <= 0) return;
+
+	int rail = RAIL - MIN_TRANSPORT;
+	for (int i = 0; i < adj->degree[from][rail]; i++) {
+		addRailMoves(adj, adj->places[from][rail][i], railHops - 1, moves);
+	}
+}
+
+/// Breadth-first search from `src` for a hunter whose first move has
+/// the given rail phase ((player + round) % 4). The phase advances by
+/// one with each move. Sets dist[p] to the number of moves needed to
+/// reach p, and firstStep[p] to the first move on the way there.
+/// Places are explored in increasing order, so the first step to each
+/// place is the one a BFS over GvGetReachable from `src` would take.
+/// Only the first step is kept, though, so a path built by following
+/// first steps (see HvGetShortestPathTo) is just as short but may go
+/// through different places in between.
+static void hunterBfs(Adjacency *adj, PlaceId src, int railPhase,
+                      int dist[NUM_REAL_PLACES],
+                      PlaceId firstStep[NUM_REAL_PLACES])
+{
+	for (int i = 0; i < NUM_REAL_PLACES; i++) {
+		dist[i] = UNREACHABLE;
+		firstStep[i] = NOWHERE;
+	}
+	dist[src] = 0;
+	firstStep[src] = src;
+
+	PlaceId queue[NUM_REAL_PLACES];
+	int head = 0;
+	int tail = 0;
+	queue[tail++] = src;
+	while (head < tail) {
+		PlaceId curr = queue[head++];
+		bool moves[NUM_REAL_PLACES];
+		hunterMoves(adj, curr, (railPhase + dist[curr]) % MAP_RAIL_PHASES,
+		            moves);
+
+		for (int i = 0; i < NUM_REAL_PLACES; i++) {
+			if (moves[i] && dist[i] == UNREACHABLE) {
+				dist[i] = dist[curr] + 1;
+				firstStep[i] = (curr == src ? (PlaceId) i : firstStep[curr]);
+				queue[tail++] = i;
+			}
+		}
+	}
+}
+
+static void printHunterDistances(Adjacency *adj)
+{
+	static int dist[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES];
+	static PlaceId firstStep[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES];
+	for (int phase = 0; phase < MAP_RAIL_PHASES; phase++) {
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			hunterBfs(adj, p, phase, dist[phase][p], firstStep[phase][p]);
+		}
+	}
+
+	printf("\nconst unsigned char MAP_HUNTER_DIST"
+	       "[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES] = {\n");
+	for (int phase = 0; phase < MAP_RAIL_PHASES; phase++) {
+		printf("\t{ // rail phase %d\n", phase);
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			printf("\t\t{");
+			for (int i = 0; i < NUM_REAL_PLACES; i++) {
+				assert(dist[phase][p][i] != UNREACHABLE);
+				printf("%d,", dist[phase][p][i]);
+			}
+			printf("}, // %s\n", PLACES[p].abbrev);
+		}
+		printf("\t},\n");
+	}
+	printf("};\n");
+
+	printf("\nconst signed char MAP_HUNTER_NEXT"
+	       "[MAP_RAIL_PHASES][NUM_REAL_PLACES][NUM_REAL_PLACES] = {\n");
+	for (int phase = 0; phase < MAP_RAIL_PHASES; phase++) {
+		printf("\t{ // rail phase %d\n", phase);
+		for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+			printf("\t\t{");
+			for (int i = 0; i < NUM_REAL_PLACES; i++) {
+				printf("%d,", firstStep[phase][p][i]);
+			}
+			printf("}, // %s\n", PLACES[p].abbrev);
+		}
+		printf("\t},\n");
+	}
+	printf("};\n");
+}
+
+////////////////////////////////////////////////////////////////////////
+// Dracula's moves
+
+static void printDraculaMoves(Adjacency *adj)
+{
+	printf("\nconst float MAP_DRACULA_MOVES"
+	       "[NUM_REAL_PLACES][MAP_PROB_STRIDE] = {\n");
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		// Staying put, or any road or boat move but to the hospital
+		bool moves[NUM_REAL_PLACES] = {false};
+		if (p != ST_JOSEPH_AND_ST_MARY) {
+			moves[p] = true;
+			for (int t = 0; t < MAP_NUM_TRANSPORTS; t++) {
+				if (t + MIN_TRANSPORT == RAIL) continue;
+				for (int i = 0; i < adj->degree[p][t]; i++) {
+					moves[adj->places[p][t][i]] = true;
+				}
+			}
+			moves[ST_JOSEPH_AND_ST_MARY] = false;
+		}
+
+		int numMoves = 0;
+		for (int i = 0; i < NUM_REAL_PLACES; i++) {
+			if (moves[i]) numMoves++;
+		}
+
+		printf("\t{");
+		for (int i = 0; i < NUM_REAL_PLACES; i++) {
+			if (moves[i]) {
+				printf("%.9gf,", 1.0 / numMoves);
+			} else {
+				printf("0,");
+			}
+		}
+		printf("}, // %s\n", PLACES[p].abbrev);
+	}
+	printf("};\n");
+}
+
+////////////////////////////////////////////////////////////////////////
+// Zobrist keys
+
+/// The next key from a splitmix64 generator with a fixed seed, so every
+/// build gets the same keys (and the same hashes)
+static uint64_t nextZobristKey(void)
+{
+	static uint64_t state = 0x2521f0d2521f0d25ULL;
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static void printZobristRow(int numKeys, bool zero)
+{
+	printf("{");
+	for (int i = 0; i < numKeys; i++) {
+		if (i % 4 == 0) printf("\n\t\t");
+		uint64_t key = (zero ? 0 : nextZobristKey());
+		printf("0x%016llxULL, ", (unsigned long long) key);
+	}
+	printf("\n\t}");
+}
+
+/// Prints a table of numRows rows of numKeys keys (or one row if
+/// numRows is 0). If firstRowIsZero is set, the first row is all 0, so
+/// that the "empty" value adds nothing to a hash.
+static void printZobristTable(const char *decl, int numRows, int numKeys,
+                              bool firstRowIsZero)
+{
+	printf("\nconst uint64_t %s = ", decl);
+	if (numRows == 0) {
+		printZobristRow(numKeys, false);
+	} else {
+		printf("{\n");
+		for (int r = 0; r < numRows; r++) {
+			printf("\t");
+			printZobristRow(numKeys, firstRowIsZero && r == 0);
+			printf(",\n");
+		}
+		printf("}");
+	}
+	printf(";\n");
+}
+
+static void printZobristKeys(void)
+{
+	printZobristTable("ZOBRIST_LOCATION[NUM_PLAYERS][ZOBRIST_NUM_IDS]",
+	                  NUM_PLAYERS, ZOBRIST_NUM_IDS, false);
+	printZobristTable("ZOBRIST_HEALTH[NUM_PLAYERS][ZOBRIST_NUM_HEALTHS]",
+	                  NUM_PLAYERS, ZOBRIST_NUM_HEALTHS, false);
+	printZobristTable("ZOBRIST_TRAIL_MOVE[TRAIL_SIZE][ZOBRIST_NUM_IDS]",
+	                  TRAIL_SIZE, ZOBRIST_NUM_IDS, false);
+	printZobristTable("ZOBRIST_TRAIL_LOCATION[TRAIL_SIZE][ZOBRIST_NUM_IDS]",
+	                  TRAIL_SIZE, ZOBRIST_NUM_IDS, false);
+	printZobristTable("ZOBRIST_TRAPS[TRAIL_SIZE + 1][ZOBRIST_NUM_IDS]",
+	                  TRAIL_SIZE + 1, ZOBRIST_NUM_IDS, true);
+	printZobristTable("ZOBRIST_VAMPIRE[ZOBRIST_NUM_IDS]",
+	                  0, ZOBRIST_NUM_IDS, false);
+	printZobristTable("ZOBRIST_PLAYER[NUM_PLAYERS]",
+	                  0, NUM_PLAYERS, false);
+	printZobristTable("ZOBRIST_ROUND[ZOBRIST_NUM_ROUNDS]",
+	                  0, ZOBRIST_NUM_ROUNDS, false);
+}
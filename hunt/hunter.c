@@ -14,7 +14,14 @@
 #include "Game.h"
 #include "hunter.h"
 #include "HunterView.h"
+#include "Mcts.h"
+#include "Rng.h"
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 
 ////////////////////////////////////////////////////////////////////////
 // Function Prototypes
@@ -23,12 +30,33 @@
 static PlaceId startingLocation(HunterView hv);
 // Returns number of hunters at location
 static int numHuntersAtLocation(HunterView hv, PlaceId location);
-// Return number of hunters who can reach a location on their next turn
-static int numHuntersReachable(HunterView hv, PlaceId location, Player hunter);
-// Near trap
-static bool nearTrap(HunterView hv, PlaceId currentLocation, PlaceId lastTrapLocation);
+// Registers better and better moves until the turn runs out
+static void searchHunterMove(HunterView hv);
+// Returns the move most likely to catch Dracula this turn
+static PlaceId captureChanceMove(HunterView hv, Rng *rng);
 
-static bool possibleDraculaLocation(HunterView hv, PlaceId location);
+// How many places Dracula can be in before it's worth searching for him
+// rather than doing anything else
+#define MCTS_MAX_CANDIDATES 12
+// How much time to leave for everything but the search
+#define MCTS_MARGIN_MSECS 250
+// How many iterations to search between looking at the clock
+#define MCTS_BATCH 256
+// The most threads to search with
+#define MAX_THREADS 16
+
+// One thread's part of the search
+typedef struct searchThread {
+    pthread_t thread;
+    bool started;
+    MctsWorker worker;
+    struct timespec deadline;
+    long iterationsLeft;     // or -1 to search until the deadline
+} SearchThread;
+
+static bool searchBatch(SearchThread *t);
+static void *runSearchThread(void *arg);
+static int searchThreads(void);
 
 void decideHunterMove(HunterView hv)
 {
@@ -36,21 +64,22 @@ void decideHunterMove(HunterView hv)
     Round round = HvGetRound(hv); Player player = HvGetPlayer(hv);
     PlaceId move = HvGetPlayerLocation(hv, player);
     int health = HvGetHealth(hv, player);
-    // Extract Dracula information
+    // Extract when Dracula was last seen
     Round roundRevealed = -1;
-    PlaceId lastDraculaLocation = HvGetLastKnownDraculaLocation(hv, &roundRevealed);
+    HvGetLastKnownDraculaLocation(hv, &roundRevealed);
     int draculaHealth = HvGetHealth(hv, PLAYER_DRACULA);
     // Extract vampire location
     PlaceId vampireLocation = HvGetVampireLocation(hv);
-    // Extract trap location
+    // Extract when a trap was last found
     Round trapRound = -1;
-    PlaceId lastTrapLocation = recentTrapEncounter(hv, &trapRound);
+    recentTrapEncounter(hv, &trapRound);
 
     // Prefer more recent trap rounds
-    if (trapRound > roundRevealed) {
-        lastDraculaLocation = lastTrapLocation;
-        roundRevealed = trapRound;
-    }
+    if (trapRound > roundRevealed) roundRevealed = trapRound;
+
+    // Every hunter's distance to every place, for finding the closest
+    HunterDistances hd;
+    HvGetHunterDistances(hv, &hd);
 
     // Register starting location
     if (round == 0) {
@@ -59,71 +88,19 @@ void decideHunterMove(HunterView hv)
         return;
     }
 
-    // Get reachable locations from current location
-    int numReturnedLocs = 0;
-    PlaceId *reachable = HvWhereCanIGo(hv, &numReturnedLocs);
-
-    // Check whether Dracula can be encountered on the next turn
-    for (int i = 0; i < numReturnedLocs; i++) {
-        PlaceId city = reachable[i];
-        if (city == move) continue;
-        if (city == lastDraculaLocation && round - roundRevealed <= 2 && placeIsReal(lastDraculaLocation)) {
-            registerBestPlay((char *)placeIdToAbbrev(city), "JAWA - we don't go by the script");
-            free(reachable);
-            return;
-        }
-    }
-
-    // BFS to Dracula location if far away
-    if (placeIsReal(lastDraculaLocation)) {
-        int pathLengthD = 0;
-        PlaceId *pathD = HvGetShortestPathTo(hv, player, lastDraculaLocation, &pathLengthD);
-        PlaceId shortestPathStep = pathD[0];
-        free(pathD);
-        if (pathLengthD > 2 && round - roundRevealed <= 9) {
-            // Move towards Dracula
-            registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
-            return;
-        } else if (pathLengthD > 1 && round - roundRevealed <= 8) {
-            // Move towards Dracula
-            registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
-            return;
-        }
-    }
-
-    // BFS to trap location if far away
-    if (placeIsReal(lastTrapLocation)) {
-        int pathLengthT = 0;
-        PlaceId *pathT = HvGetShortestPathTo(hv, player, lastTrapLocation, &pathLengthT);
-        PlaceId shortestPathStep = pathT[0];
-        free(pathT);
-        if (pathLengthT > 2 && round - roundRevealed <= 9) {
-            // Move towards trap location
-            registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
-            return;
-        } else if (pathLengthT > 1 && round - roundRevealed <= 8) {
-            // Move towards trap location
-            registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
-            return;
-        }
+    // Once the places Dracula could be are few enough, search for the
+    // move most likely to catch him
+    if (HvGetNumDraculaCandidates(hv) <= MCTS_MAX_CANDIDATES) {
+        searchHunterMove(hv);
+        return;
     }
 
     // Vampire
     if (placeIsReal(vampireLocation)) {
-        // Calculate shortest path to location
-        Player closestPlayer = -1; int minPathLength = 100000;
-        PlaceId shortestPathStep = NOWHERE;
-        for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA; hunter++) {
-            // Calculate path
-            int pathLength = 0;
-            PlaceId *path = HvGetShortestPathTo(hv, hunter, vampireLocation, &pathLength);
-            if (pathLength < minPathLength) {
-                closestPlayer = hunter;
-                minPathLength = pathLength;
-                shortestPathStep = path[0];
-            }
-            free(path);
-        }
+        // Closest hunter to the vampire
+        Player closestPlayer = hd.closest[vampireLocation];
+        int minPathLength = hd.minDist[vampireLocation];
+        PlaceId shortestPathStep = HvGetNextStep(hv, closestPlayer, vampireLocation);
         // Noone already there
         if (placeIsReal(shortestPathStep) && player == closestPlayer && minPathLength != 0) {
             registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
@@ -144,19 +121,9 @@ void decideHunterMove(HunterView hv)
     }
 
     // Guard CASTLE_DRACULA
-    Player closestPlayer = -1; int minPathLength = 100000;
-    PlaceId shortestPathStep = NOWHERE;
-    for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA; hunter++) {
-        // Calculate path
-        int pathLength = 0;
-        PlaceId *path = HvGetShortestPathTo(hv, hunter, CASTLE_DRACULA, &pathLength);
-        if (pathLength < minPathLength) {
-            closestPlayer = hunter;
-            minPathLength = pathLength;
-            shortestPathStep = path[0];
-        }
-        free(path);
-    }
+    Player closestPlayer = hd.closest[CASTLE_DRACULA];
+    int minPathLength = hd.minDist[CASTLE_DRACULA];
+    PlaceId shortestPathStep = HvGetNextStep(hv, closestPlayer, CASTLE_DRACULA);
     // Move towards
     if (draculaHealth <= 20 && player == closestPlayer && minPathLength > 3) {
         registerBestPlay((char *)placeIdToAbbrev(shortestPathStep), "JAWA - we don't go by the script");
@@ -171,74 +138,166 @@ void decideHunterMove(HunterView hv)
     }
 
     // Default movement
-    PlaceId *generalReachable = HvWhereCanIGo(hv, &numReturnedLocs);
-    // If Dracula at sea
-    if (placeIsSea(HvGetPlayerLocation(hv, PLAYER_DRACULA))) {
-        // Try to move to sea
-        PlaceId *generalReachable = HvWhereCanIGoByType(hv, false, false, true, &numReturnedLocs);
-        if (numReturnedLocs == 0) {
-            // Revert to default movement
-            free(generalReachable);
-            generalReachable = HvWhereCanIGo(hv, &numReturnedLocs);
-        }
+    searchHunterMove(hv);
+}
+
+// Registers the move most likely to catch Dracula this turn, then keeps
+// replacing it with the best move found by searching further ahead,
+// until the deadline. Every thread runs its own worker on the same
+// search, and this one registers the best move after each batch.
+//
+// FOD_TURN_MSECS in the environment overrides how long a turn can take,
+// FOD_MCTS_ITERATIONS runs exactly that many iterations (between all the
+// threads) with no deadline, so the moves chosen don't depend on how
+// fast the machine is, FOD_THREADS sets the number of threads, and
+// FOD_SEED picks which random numbers are used (see Rng.h).
+static void searchHunterMove(HunterView hv)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+
+    // Seeded by the turn, so a game replays the same way. The search
+    // threads take streams 0 to MAX_THREADS - 1, and this the next one
+    uint64_t seed = rngTurnSeed(HvGetRound(hv), HvGetPlayer(hv));
+    Rng rng = rngNew(seed + ((uint64_t) MAX_THREADS << 40));
+    PlaceId move = captureChanceMove(hv, &rng);
+    registerBestPlay((char *)placeIdToAbbrev(move), "JAWA - we don't go by the script");
+
+    long msecs = TURN_LIMIT_MSECS - MCTS_MARGIN_MSECS;
+    char *turnMsecs = getenv("FOD_TURN_MSECS");
+    if (turnMsecs != NULL) msecs = atol(turnMsecs) - MCTS_MARGIN_MSECS;
+    long maxIterations = -1;
+    char *iterations = getenv("FOD_MCTS_ITERATIONS");
+    if (iterations != NULL) maxIterations = atol(iterations);
+
+    if (msecs < 0) msecs = 0;
+    deadline.tv_sec += msecs / 1000;
+    deadline.tv_nsec += (msecs % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
     }
 
-    // Find minimum number 
-    int moveWeight[NUM_REAL_PLACES] = {0}; int minimumWeight = 100000;
-    for (int i = 0; i < numReturnedLocs; i++) {
-        PlaceId option = generalReachable[i];
-        moveWeight[i] = 5 * numHuntersAtLocation(hv, option);
-        moveWeight[i] += numHuntersReachable(hv, option, player);
-        moveWeight[i] += 2 * visited(hv, option);
-        moveWeight[i] += inTrail(hv, option);
-        moveWeight[i] -= possibleDraculaLocation(hv, option);
-        if (round - trapRound < 2) moveWeight[i] -= 2 * nearTrap(hv, move, lastTrapLocation);
-        moveWeight[i] -= 1 * nearTrap(hv, move, lastTrapLocation);
-        if (moveWeight[i] < minimumWeight) minimumWeight = moveWeight[i];
+    Mcts m = MctsNew(hv);
+    int numThreads = searchThreads();
+    SearchThread threads[MAX_THREADS];
+    for (int i = 0; i < numThreads; i++) {
+        threads[i].worker = MctsWorkerNew(m, seed + ((uint64_t) i << 40));
+        threads[i].deadline = deadline;
+        threads[i].iterationsLeft = -1;
+        if (maxIterations >= 0) {
+            threads[i].iterationsLeft = maxIterations / numThreads +
+                                        (i < maxIterations % numThreads);
+        }
+    }
+    for (int i = 1; i < numThreads; i++) {
+        threads[i].started = pthread_create(&threads[i].thread, NULL,
+                                            runSearchThread, &threads[i]) == 0;
     }
 
-    // Select minimum weights
-    int arrSize = 0;
-    int minimumIndices[NUM_REAL_PLACES] = {0};
-    for (int i = 0; i < numReturnedLocs; i++) {
-        if (moveWeight[i] >= minimumWeight && moveWeight[i] <= minimumWeight + 4) {
-            // Append to new array of minimum weights
-            minimumIndices[arrSize] = i;
-            arrSize++;
+    // Until the search has tried something, keep the move registered
+    // above rather than the first one it would try
+    while (searchBatch(&threads[0])) {
+        PlaceId best = MctsBestMove(m);
+        if (best != NOWHERE && best != move) {
+            move = best;
+            registerBestPlay((char *)placeIdToAbbrev(move), "JAWA - we don't go by the script");
         }
     }
-    int indexOfMin = rand() % arrSize;
-    // Prevent idle
-    if (arrSize == 0) {
-        int index = rand() % numReturnedLocs;
-        if (generalReachable[index] == move) index = (index + 1) % numReturnedLocs;
-        registerBestPlay((char *)placeIdToAbbrev(generalReachable[index]), "JAWA - we don't go by the script");
-        free(generalReachable);
-        return;
+
+    for (int i = 1; i < numThreads; i++) {
+        if (threads[i].started) pthread_join(threads[i].thread, NULL);
+    }
+    PlaceId best = MctsBestMove(m);
+    if (best != NOWHERE && best != move)
+        registerBestPlay((char *)placeIdToAbbrev(best), "JAWA - we don't go by the script");
+
+    for (int i = 0; i < numThreads; i++)
+        MctsWorkerFree(threads[i].worker);
+    MctsFree(m);
+}
+
+// Runs another batch of iterations on the thread's worker, or returns
+// false if its part of the search is over
+static bool searchBatch(SearchThread *t)
+{
+    long batch = MCTS_BATCH;
+    if (t->iterationsLeft >= 0) {
+        if (t->iterationsLeft == 0) return false;
+        if (t->iterationsLeft < batch) batch = t->iterationsLeft;
+        t->iterationsLeft -= batch;
+    } else {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        if (now.tv_sec > t->deadline.tv_sec ||
+            (now.tv_sec == t->deadline.tv_sec && now.tv_nsec >= t->deadline.tv_nsec))
+            return false;
     }
-    int index = minimumIndices[indexOfMin];
-    if (generalReachable[index] == move) indexOfMin = (indexOfMin + 1) % arrSize;
-    index = minimumIndices[indexOfMin];
-    if (generalReachable[index] == move) index = rand() % numReturnedLocs;
-    registerBestPlay((char *)placeIdToAbbrev(generalReachable[index]), "JAWA - we don't go by the script");
-    free(generalReachable);
-    return;
+    MctsWorkerRun(t->worker, batch);
+    return true;
+}
+
+static void *runSearchThread(void *arg)
+{
+    while (searchBatch(arg));
+    return NULL;
+}
+
+// Gets how many threads to search with: FOD_THREADS if it's set, or
+// else one for each core
+static int searchThreads(void)
+{
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    char *threads = getenv("FOD_THREADS");
+    if (threads != NULL) numThreads = atol(threads);
+    if (numThreads < 1) numThreads = 1;
+    if (numThreads > MAX_THREADS) numThreads = MAX_THREADS;
+    return numThreads;
 }
 
-static bool possibleDraculaLocation(HunterView hv, PlaceId location) {
+// Returns the move with the best chance of catching Dracula this turn,
+// without piling onto the other hunters
+static PlaceId captureChanceMove(HunterView hv, Rng *rng)
+{
+    Player player = HvGetPlayer(hv);
+    PlaceId move = HvGetPlayerLocation(hv, player);
     int numReturnedLocs = 0;
-    PlaceId *possible = HvWhereCanTheyGo(hv, PLAYER_DRACULA, &numReturnedLocs);
+    PlaceId generalReachable[NUM_REAL_PLACES];
+    HvWhereCanIGoInto(hv, generalReachable, &numReturnedLocs);
+    float bestChance = 0;
+    int numBest = 0;
+    PlaceId best[NUM_REAL_PLACES];
     for (int i = 0; i < numReturnedLocs; i++) {
-        if (possible[i] == location) {
-            free(possible);
-            return true;
+        PlaceId option = generalReachable[i];
+        int others = numHuntersAtLocation(hv, option) - (option == move);
+        float chance = HvGetCaptureChance(hv, player, option) / (1 + others);
+        if (chance > bestChance + 1e-6f) {
+            bestChance = chance;
+            numBest = 0;
         }
+        if (chance >= bestChance - 1e-6f) best[numBest++] = option;
     }
-    free(possible);
-    return false;
-}
 
+    // Nowhere gives a chance this turn, so head for where he most
+    // likely is
+    if (bestChance == 0) {
+        PlaceId likeliest = NOWHERE; float maxProb = 0;
+        for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+            float prob = HvGetDraculaProbability(hv, p);
+            if (prob > maxProb) {
+                maxProb = prob;
+                likeliest = p;
+            }
+        }
+        if (placeIsReal(likeliest) && likeliest != move)
+            return HvGetNextStep(hv, player, likeliest);
+    }
 
+    // Prevent idle
+    int index = rngBelow(rng, numBest);
+    if (best[index] == move && numBest > 1) index = (index + 1) % numBest;
+    return best[index];
+}
 
 // Registers a starting location for a player
 static PlaceId startingLocation(HunterView hv)
@@ -266,38 +325,3 @@ static int numHuntersAtLocation(HunterView hv, PlaceId location)
         if (HvGetPlayerLocation(hv, player) == location) numHunters++;
     return numHunters;
 }
-
-// Return number of hunters who can reach a location on their next turn
-static int numHuntersReachable(HunterView hv, PlaceId location, Player hunter)
-{
-    int numHunters = 0;
-    for (Player player = PLAYER_LORD_GODALMING; player < PLAYER_DRACULA; player++) {
-        // Where can the other hunters go
-        if (player == hunter) continue;
-        int numReturnedLocs = 0;
-        PlaceId *playerReachable = HvWhereCanTheyGoByType(hv, player, true, false, true, &numReturnedLocs);
-        for (int i = 0; i < numReturnedLocs; i++) {
-            if (playerReachable[i] == location) {
-                numHunters++;
-                break;
-            }
-        }
-        free(playerReachable);
-    }
-    return numHunters;
-}
-
-// Near trap
-static bool nearTrap(HunterView hv, PlaceId currentLocation, PlaceId lastTrapLocation) {
-    if (lastTrapLocation == NOWHERE) return false;
-    int numReturnedLocs = 0;
-    PlaceId *reachable = HvWhereCanIGo(hv, &numReturnedLocs);
-    for (int i = 0; i < numReturnedLocs; i++) {
-        if (reachable[i] == lastTrapLocation) {
-            free(reachable);
-            return true;
-        }
-    }
-    free(reachable);
-    return false;
-}
@@ -14,6 +14,7 @@
 #include "Game.h"
 #include "hunter.h"
 #include "HunterView.h"
+#include "Rng.h"
 #include <stdio.h>
 
 ////////////////////////////////////////////////////////////////////////
@@ -56,6 +57,7 @@ void decideHunterMove(HunterView hv)
     // Extract player/game state information
     Round round = HvGetRound(hv); Player player = HvGetPlayer(hv);
     PlaceId move = HvGetPlayerLocation(hv, player);
+    Rng rng = rngNew(rngTurnSeed(round, player));
     int health = HvGetHealth(hv, player);
     // Extract Dracula information
     Round roundRevealed = -1;
@@ -233,10 +235,10 @@ void decideHunterMove(HunterView hv)
             arrSize++;
         }
     }
-    int indexOfMin = rand() % arrSize;
+    int indexOfMin = rngBelow(&rng, arrSize);
     // Prevent idle
     if (arrSize == 0) {
-        int index = rand() % numReturnedLocs;
+        int index = rngBelow(&rng, numReturnedLocs);
         if (generalReachable[index] == move) index = (index + 1) % numReturnedLocs;
         registerBestPlay((char *)placeIdToAbbrev(generalReachable[index]), "JAWA - we don't go by the script");
         free(generalReachable);
@@ -245,7 +247,7 @@ void decideHunterMove(HunterView hv)
     int index = minimumIndices[indexOfMin];
     if (generalReachable[index] == move) indexOfMin = (indexOfMin + 1) % arrSize;
     index = minimumIndices[indexOfMin];
-    if (generalReachable[index] == move) index = rand() % numReturnedLocs;
+    if (generalReachable[index] == move) index = rngBelow(&rng, numReturnedLocs);
     registerBestPlay((char *)placeIdToAbbrev(generalReachable[index]), "JAWA - we don't go by the script");
     free(generalReachable);
     return;
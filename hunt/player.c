@@ -20,6 +20,12 @@
 // decideMove function if it goes into an infinite loop. Sort  that  out
 // before you submit.
 //
+// Run with -p to keep one view for a whole game: each line read from
+// stdin is the pastPlays string for the next turn of the same game, and
+// the move decided for it is printed. Usually only the new plays in each
+// line are processed, but a line may also reveal Dracula's earlier moves
+// (as the game engine does), in which case the view is rebuilt.
+//
 // Based on the program by David Collien, written in 2012
 //
 // 2017-12-04	v1.1	Team Dracula <cs2521@cse.unsw.edu.au>
@@ -50,13 +56,14 @@ static char latestMessage[MESSAGE_SIZE] = "";
 
 // A pseudo-generic interface, which defines
 // - a type `View',
-// - functions `ViewNew', `decideMove', `ViewFree',
+// - functions `ViewNew', `ViewUpdate', `decideMove', `ViewFree',
 // - a trail `xtrail', and a message buffer `xmsgs'.
 #ifdef I_AM_DRACULA
 
 typedef DraculaView View;
 
 # define ViewNew DvNew
+# define ViewUpdate DvUpdate
 # define decideMove decideDraculaMove
 # define ViewFree DvFree
 
@@ -68,6 +75,7 @@ typedef DraculaView View;
 typedef HunterView View;
 
 # define ViewNew HvNew
+# define ViewUpdate HvUpdate
 # define decideMove decideHunterMove
 # define ViewFree HvFree
 
@@ -76,8 +84,14 @@ typedef HunterView View;
 
 #endif
 
-int main(void)
+static int playPersistent(void);
+
+int main(int argc, char *argv[])
 {
+	if (argc > 1 && strcmp(argv[1], "-p") == 0) {
+		return playPersistent();
+	}
+
 	char *pastPlays = xPastPlays;
 	Message msgs[] = xMsgs;
 
@@ -89,6 +103,37 @@ int main(void)
 	return EXIT_SUCCESS;
 }
 
+// Decides a move for each pastPlays line on stdin, using the same view
+static int playPersistent(void)
+{
+	View state = NULL;
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t length;
+
+	while ((length = getline(&line, &size, stdin)) != -1) {
+		if (length > 0 && line[length - 1] == '\n') {
+			line[--length] = '\0';
+		}
+
+		if (state == NULL) {
+			// Messages are ignored by the AIs, so none are passed in
+			state = ViewNew(line, NULL);
+		} else {
+			ViewUpdate(state, line);
+		}
+
+		latestPlay[0] = latestMessage[0] = '\0';
+		decideMove(state);
+		printf("Move: %s, Message: %s\n", latestPlay, latestMessage);
+		fflush(stdout);
+	}
+
+	if (state != NULL) ViewFree(state);
+	free(line);
+	return EXIT_SUCCESS;
+}
+
 // Saves characters from play (and appends a terminator)
 // and saves characters from message (and appends a terminator)
 void registerBestPlay(char *play, Message message)
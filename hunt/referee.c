@@ -0,0 +1,248 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// referee.c: plays whole games between dracula.c and hunter.c
+//
+// The referee plays the game engine's part with a Match (see Match.h),
+// which decides what each player is shown.
+//
+// Each decision runs in a child process, which sends every move it
+// registers back through a pipe. Like the game engine, the referee
+// takes the last move registered within TURN_LIMIT_MSECS and kills the
+// child if it is still going; an AI that crashes, times out without a
+// move, or makes an illegal move is given the first legal move instead.
+//
+// Usage: ./referee [-n games] [-s seed] [-t msecs] [-v]
+//   -n  the number of games to play (default 1)
+//   -s  the seed for the first game; game i uses seed + i (default 0),
+//       which the AIs are given as FOD_SEED (see Rng.h)
+//   -t  the time limit for each decision (default TURN_LIMIT_MSECS),
+//       which the AIs are also given as FOD_TURN_MSECS
+//   -v  print the real play string of each game
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dracula.h"
+#include "DraculaView.h"
+#include "Game.h"
+#include "hunter.h"
+#include "HunterView.h"
+#include "Match.h"
+#include "Places.h"
+
+// Moves sent back through the pipe are this long (including newline)
+#define MOVE_SIZE 3
+
+typedef struct game {
+	Match m;
+
+	// Statistics
+	int numBadMoves[NUM_PLAYERS];    // illegal, missing or late moves
+	long maxMsecs[NUM_PLAYERS];      // the slowest decision
+} Game;
+
+// Where the child process sends its moves
+static int moveFd = -1;
+
+static void playGame(Game *g, unsigned seed, long turnMsecs);
+static PlaceId decide(Game *g, Player player, long turnMsecs, long *msecs);
+static long msecsSince(struct timespec *start);
+
+int main(int argc, char *argv[])
+{
+	int numGames = 1;
+	unsigned seed = 0;
+	long turnMsecs = TURN_LIMIT_MSECS;
+	bool verbose = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:s:t:v")) != -1) {
+		switch (opt) {
+			case 'n': numGames = atoi(optarg); break;
+			case 's': seed = strtoul(optarg, NULL, 10); break;
+			case 't': turnMsecs = atol(optarg); break;
+			case 'v': verbose = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-n games] [-s seed] "
+				        "[-t msecs] [-v]\n", argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+
+	// A child being killed shouldn't take the referee with it
+	signal(SIGPIPE, SIG_IGN);
+
+	int numHunterWins = 0;
+	long totalScore = 0;
+	for (int i = 0; i < numGames; i++) {
+		Game *g = malloc(sizeof(*g));
+		if (g == NULL) {
+			fprintf(stderr, "Couldn't allocate Game!\n");
+			exit(EXIT_FAILURE);
+		}
+		playGame(g, seed + i, turnMsecs);
+
+		int score = MatchGetScore(g->m);
+		bool huntersWon = MatchGetHealth(g->m, PLAYER_DRACULA) <= 0;
+		numHunterWins += huntersWon;
+		totalScore += score;
+		long hunterMsecs = 0;
+		for (Player hunter = PLAYER_LORD_GODALMING; hunter < PLAYER_DRACULA;
+		     hunter++) {
+			if (g->maxMsecs[hunter] > hunterMsecs)
+				hunterMsecs = g->maxMsecs[hunter];
+		}
+		printf("game %d (seed %u): %s, score %d, round %d, Dracula's "
+		       "health %d, bad moves %d/%d/%d/%d/%d, slowest hunter %ldms, "
+		       "slowest Dracula %ldms\n",
+		       i, seed + i, huntersWon ? "hunters won" : "Dracula won",
+		       score, MatchGetRound(g->m), MatchGetHealth(g->m, PLAYER_DRACULA),
+		       g->numBadMoves[0], g->numBadMoves[1], g->numBadMoves[2],
+		       g->numBadMoves[3], g->numBadMoves[4], hunterMsecs,
+		       g->maxMsecs[PLAYER_DRACULA]);
+		if (verbose) printf("%s\n", MatchGetPlays(g->m));
+		fflush(stdout);
+
+		MatchFree(g->m);
+		free(g);
+	}
+
+	printf("%d games: hunters won %d, Dracula won %d, average score %.1f\n",
+	       numGames, numHunterWins, numGames - numHunterWins,
+	       numGames > 0 ? (double) totalScore / numGames : 0.0);
+	return EXIT_SUCCESS;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Playing a game
+
+static void playGame(Game *g, unsigned seed, long turnMsecs)
+{
+	g->m = MatchNew();
+	for (int player = 0; player < NUM_PLAYERS; player++) {
+		g->numBadMoves[player] = 0;
+		g->maxMsecs[player] = 0;
+	}
+
+	// The AIs work out a seed for each turn from this
+	char gameSeed[32];
+	snprintf(gameSeed, sizeof(gameSeed), "%u", seed);
+	setenv("FOD_SEED", gameSeed, 1);
+
+	while (!MatchIsOver(g->m)) {
+		Player player = MatchGetPlayer(g->m);
+		long msecs;
+		PlaceId move = decide(g, player, turnMsecs, &msecs);
+		if (msecs > g->maxMsecs[player]) g->maxMsecs[player] = msecs;
+		if (!MatchPlay(g->m, move)) g->numBadMoves[player]++;
+	}
+}
+
+/**
+ * Runs the player's AI in a child process, and returns the last move it
+ * registered in time (or NOWHERE if there wasn't one). Sets *msecs to
+ * how long it took.
+ */
+static PlaceId decide(Game *g, Player player, long turnMsecs, long *msecs)
+{
+	static char pastPlays[MATCH_PLAYS_SIZE];
+	MatchGetPastPlays(g->m, player, pastPlays);
+
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		exit(EXIT_FAILURE);
+	}
+	fflush(stdout);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pid_t pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		exit(EXIT_FAILURE);
+	}
+
+	if (pid == 0) {
+		close(fds[0]);
+		moveFd = fds[1];
+
+		// Tell the AI how long it has, unless it's been told already
+		char limit[32];
+		snprintf(limit, sizeof(limit), "%ld", turnMsecs);
+		setenv("FOD_TURN_MSECS", limit, 0);
+		if (player == PLAYER_DRACULA) {
+			decideDraculaMove(DvNew(pastPlays, NULL));
+		} else {
+			decideHunterMove(HvNew(pastPlays, NULL));
+		}
+		_exit(EXIT_SUCCESS);
+	}
+
+	close(fds[1]);
+	char buf[256];
+	int length = 0;
+	char latest[MOVE_SIZE] = "";
+	bool finished = false;
+	while (!finished) {
+		long left = turnMsecs - msecsSince(&start);
+		if (left <= 0) break;
+
+		struct pollfd pfd = { .fd = fds[0], .events = POLLIN };
+		int ready = poll(&pfd, 1, left);
+		if (ready < 0 && errno == EINTR) continue;
+		if (ready <= 0) break;
+
+		ssize_t n = read(fds[0], buf + length, sizeof(buf) - length);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) {
+			finished = true;
+			break;
+		}
+		length += n;
+
+		// Only complete moves count
+		int used = 0;
+		for (; length - used >= MOVE_SIZE; used += MOVE_SIZE) {
+			latest[0] = buf[used];
+			latest[1] = buf[used + 1];
+			latest[2] = '\0';
+		}
+		memmove(buf, buf + used, length - used);
+		length -= used;
+	}
+	*msecs = msecsSince(&start);
+
+	if (!finished) kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+	close(fds[0]);
+	return latest[0] == '\0' ? NOWHERE : placeAbbrevToId(latest);
+}
+
+// Sends the move to the referee, as the child process
+void registerBestPlay(char *play, Message message)
+{
+	char move[MOVE_SIZE] = { play[0], play[0] == '\0' ? '\0' : play[1], '\n' };
+	if (moveFd >= 0 && write(moveFd, move, MOVE_SIZE) != MOVE_SIZE) {
+		_exit(EXIT_FAILURE);
+	}
+}
+
+static long msecsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000 +
+	       (now.tv_nsec - start->tv_nsec) / 1000000;
+}
@@ -0,0 +1,269 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// testGameView.c: test the parts of the GameView ADT that the AIs add
+//
+// The views in view/ are tested there; these tests replay the game in
+// TEST_GAME_LOG to check that the faster ways of getting to a state
+// end up in the same place as GvNew, and that moves made in place can
+// be taken back exactly.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+#include "GameView.h"
+#include "MapData.h"
+#include "Places.h"
+#include "Plays.h"
+#include "testUtils.h"
+
+static void assertSameView(GameView gv, GameView expected);
+static uint64_t hashFromScratch(GameState *s);
+
+int main(void)
+{
+	int numPastPlays = 0;
+	char **pastPlays = readPastPlays(TEST_GAME_LOG, &numPastPlays);
+	assert(numPastPlays > 0);
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Updating one view for the whole game\n");
+		
+		// The game engine reveals some of Dracula's moves after the
+		// fact, so some strings don't just extend the one before
+		int numRewrites = 0;
+		GameView gv = GvNew("", NULL);
+		for (int i = 0; i < numPastPlays; i++) {
+			if (i > 0 && strncmp(pastPlays[i], pastPlays[i - 1],
+			                     strlen(pastPlays[i - 1])) != 0) {
+				numRewrites++;
+			}
+			GvUpdate(gv, pastPlays[i]);
+			GameView expected = GvNew(pastPlays[i], NULL);
+			assertSameView(gv, expected);
+			GvFree(expected);
+		}
+		assert(numRewrites > 0);
+		
+		// Going back to an earlier turn starts again
+		GvUpdate(gv, pastPlays[numPastPlays / 2]);
+		GameView expected = GvNew(pastPlays[numPastPlays / 2], NULL);
+		assertSameView(gv, expected);
+		GvFree(expected);
+		GvFree(gv);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Updating one view from parsed plays\n");
+		
+		TurnBuffer buf;
+		TurnBufferInit(&buf);
+		GameView gv = GvNew("", NULL);
+		for (int i = 0; i < numPastPlays; i++) {
+			assert(TurnBufferParse(&buf, pastPlays[i]));
+			GvUpdateFromTurns(gv, &buf);
+			GameView expected = GvNew(pastPlays[i], NULL);
+			assertSameView(gv, expected);
+			GvFree(expected);
+		}
+		
+		assert(TurnBufferParse(&buf, pastPlays[numPastPlays / 2]));
+		GvUpdateFromTurns(gv, &buf);
+		GameView expected = GvNew(pastPlays[numPastPlays / 2], NULL);
+		assertSameView(gv, expected);
+		GvFree(expected);
+		GvFree(gv);
+		TurnBufferFree(&buf);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Applying and undoing every move of the game\n");
+		
+		char *game = pastPlays[numPastPlays - 1];
+		int numTurns = (strlen(game) + 1) / PLAY_SIZE;
+		for (int i = 0; i < numTurns; i++) {
+			char *before = strndup(game, i > 0 ? i * PLAY_SIZE - 1 : 0);
+			char *after = strndup(game, (i + 1) * PLAY_SIZE - 1);
+			GameView gv = GvNew(before, NULL);
+			GameView expected = GvNew(after, NULL);
+			GameState start = GvGetState(gv);
+			
+			Player player = i % NUM_PLAYERS;
+			int numMoves = 0;
+			bool canFree = false;
+			PlaceId *moves = GvGetMoveHistory(expected, player, &numMoves,
+			                                  &canFree);
+			PlaceId move = moves[numMoves - 1];
+			if (canFree) free(moves);
+			
+			// With the encounters from the log, and then with the ones
+			// the view works out for itself
+			char *encounters = &game[i * PLAY_SIZE + 3];
+			for (int worked = 0; worked < 2; worked++) {
+				GvUndo undo;
+				GvApplyMove(gv, player, move, worked ? NULL : encounters, &undo);
+				assertSameView(gv, expected);
+				GvUndoMove(gv, &undo);
+				GameState state = GvGetState(gv);
+				assert(sameState(&state, &start));
+				assert(GvGetNumTurns(gv) == i);
+			}
+			
+			GvFree(expected);
+			GvFree(gv);
+			free(after);
+			free(before);
+		}
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Undoing a whole game in reverse\n");
+		
+		char *game = pastPlays[numPastPlays - 1];
+		int numTurns = (strlen(game) + 1) / PLAY_SIZE;
+		GameView expected = GvNew(game, NULL);
+		GameView gv = GvNew("", NULL);
+		GvUndo *undos = malloc(numTurns * sizeof(GvUndo));
+		assert(undos != NULL);
+		
+		// The history has to grow as the game goes on
+		for (int i = 0; i < numTurns; i++) {
+			Player player = i % NUM_PLAYERS;
+			int numMoves = 0;
+			bool canFree = false;
+			PlaceId *moves = GvGetMoveHistory(expected, player, &numMoves,
+			                                  &canFree);
+			GvApplyMove(gv, player, moves[i / NUM_PLAYERS],
+			            &game[i * PLAY_SIZE + 3], &undos[i]);
+			if (canFree) free(moves);
+		}
+		assertSameView(gv, expected);
+		
+		for (int i = numTurns - 1; i >= 0; i--) {
+			GvUndoMove(gv, &undos[i]);
+			GameState state = GvGetState(gv);
+			assert(sameState(&state, &undos[i].state));
+			assert(GvGetNumTurns(gv) == i);
+		}
+		GameView empty = GvNew("", NULL);
+		assertSameView(gv, empty);
+		
+		GvFree(empty);
+		free(undos);
+		GvFree(gv);
+		GvFree(expected);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Hashing every state of the game\n");
+		
+		// Each state's hash is checked against one worked out from
+		// scratch, and no two different states may share one
+		char *game = pastPlays[numPastPlays - 1];
+		int numTurns = (strlen(game) + 1) / PLAY_SIZE;
+		GameState *states = malloc((numTurns + 1) * sizeof(GameState));
+		assert(states != NULL);
+		GameView gv = GvNew("", NULL);
+		for (int i = 0; i <= numTurns; i++) {
+			char *plays = strndup(game, i > 0 ? i * PLAY_SIZE - 1 : 0);
+			GvUpdate(gv, plays);
+			GameView expected = GvNew(plays, NULL);
+			states[i] = GvGetState(gv);
+			assert(GvHash(gv) == states[i].hash);
+			assert(GvHash(gv) == GvHash(expected));
+			assert(GvHash(gv) == hashFromScratch(&states[i]));
+			GvFree(expected);
+			free(plays);
+		}
+		GvFree(gv);
+		
+		for (int i = 0; i <= numTurns; i++) {
+			for (int j = i + 1; j <= numTurns; j++) {
+				assert(states[i].hash != states[j].hash ||
+				       sameState(&states[i], &states[j]));
+			}
+		}
+		free(states);
+		
+		printf("Test passed!\n");
+	}
+	
+	freePastPlays(pastPlays, numPastPlays);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Asserts that two views have the same state and history
+ */
+static void assertSameView(GameView gv, GameView expected) {
+	GameState state = GvGetState(gv);
+	GameState expectedState = GvGetState(expected);
+	assert(sameState(&state, &expectedState));
+	assert(GvGetNumTurns(gv) == GvGetNumTurns(expected));
+	
+	for (int player = 0; player < NUM_PLAYERS; player++) {
+		int numMoves = 0, numExpected = 0;
+		bool canFree = false, canFreeExpected = false;
+		PlaceId *moves = GvGetMoveHistory(gv, player, &numMoves, &canFree);
+		PlaceId *expectedMoves = GvGetMoveHistory(expected, player,
+		                                          &numExpected,
+		                                          &canFreeExpected);
+		assert(numMoves == numExpected);
+		assert(memcmp(moves, expectedMoves, numMoves * sizeof(PlaceId)) == 0);
+		if (canFree) free(moves);
+		if (canFreeExpected) free(expectedMoves);
+		
+		numMoves = numExpected = 0;
+		moves = GvGetLocationHistory(gv, player, &numMoves, &canFree);
+		expectedMoves = GvGetLocationHistory(expected, player, &numExpected,
+		                                     &canFreeExpected);
+		assert(numMoves == numExpected);
+		assert(memcmp(moves, expectedMoves, numMoves * sizeof(PlaceId)) == 0);
+		if (canFree) free(moves);
+		if (canFreeExpected) free(expectedMoves);
+	}
+}
+
+/**
+ * Works out the Zobrist hash of a state from its keys (see MapData.h)
+ */
+static uint64_t hashFromScratch(GameState *s) {
+	uint64_t hash = ZOBRIST_PLAYER[s->player] ^
+	                ZOBRIST_ROUND[ZOBRIST_ROUND_ID(s->round)] ^
+	                ZOBRIST_VAMPIRE[ZOBRIST_ID(s->vampire)];
+	for (int i = 0; i < NUM_PLAYERS; i++) {
+		hash ^= ZOBRIST_LOCATION[i][ZOBRIST_ID(s->location[i])] ^
+		        ZOBRIST_HEALTH[i][ZOBRIST_HEALTH_ID(s->health[i])];
+	}
+	for (int i = 0; i < s->trailLength; i++) {
+		hash ^= ZOBRIST_TRAIL_MOVE[i][ZOBRIST_ID(s->trailMoves[i])] ^
+		        ZOBRIST_TRAIL_LOCATION[i][ZOBRIST_ID(s->trailLocations[i])];
+	}
+	
+	int numTraps[ZOBRIST_NUM_IDS] = { 0 };
+	for (int i = 0; i < s->numTraps; i++) {
+		numTraps[ZOBRIST_ID(s->traps[i])]++;
+	}
+	for (int id = 0; id < ZOBRIST_NUM_IDS; id++) {
+		hash ^= ZOBRIST_TRAPS[numTraps[id]][id];
+	}
+	return hash;
+}
@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// testHunterView.c: test the parts of the HunterView ADT that the AIs
+// add
+//
+// Like testGameView.c, these replay the game in TEST_GAME_LOG. What
+// the hunters believe about Dracula is checked against where he really
+// is in games played by Match, with every player moving at random.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DraculaView.h"
+#include "Game.h"
+#include "GameView.h"
+#include "HunterView.h"
+#include "Match.h"
+#include "PlaceSet.h"
+#include "Places.h"
+#include "Rng.h"
+#include "testUtils.h"
+
+// How many games to play at random
+#define NUM_RANDOM_GAMES 20
+
+static void assertSameBeliefs(HunterView hv, HunterView expected);
+static void playRandomGames(void (*check)(HunterView hv, PlaceId dracula));
+static PlaceId randomMove(Match m, Rng *rng);
+static void checkCandidates(HunterView hv, PlaceId dracula);
+static void checkProbabilities(HunterView hv, PlaceId dracula);
+static void assertDistribution(float probs[static NUM_REAL_PLACES]);
+
+int main(void)
+{
+	int numPastPlays = 0;
+	char **pastPlays = readPastPlays(TEST_GAME_LOG, &numPastPlays);
+	assert(numPastPlays > 0);
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Updating one view for the whole game\n");
+		
+		// Including the strings where Dracula's earlier moves have been
+		// revealed since the last one
+		HunterView hv = HvNew("", NULL);
+		for (int i = 0; i < numPastPlays; i++) {
+			HvUpdate(hv, pastPlays[i]);
+			HunterView expected = HvNew(pastPlays[i], NULL);
+			assertSameBeliefs(hv, expected);
+			HvFree(expected);
+		}
+		HvFree(hv);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Hidden sea moves follow the trail rule\n");
+		
+		// Black Sea -> Ionian Sea -> S?, and the Black Sea is still in
+		// his trail, so he can only be in the other seas next to it
+		char *pastPlays =
+			"GSZ.... SSZ.... HSZ.... MSZ.... DBS.... "
+			"GSZ.... SSZ.... HSZ.... MSZ.... DIO.... "
+			"GSZ.... SSZ.... HSZ.... MSZ.... DS?....";
+		HunterView hv = HvNew(pastPlays, NULL);
+		PlaceSet expected = placeSetAdd(placeSetOf(ADRIATIC_SEA),
+		                                TYRRHENIAN_SEA);
+		assert(placeSetEquals(HvGetDraculaCandidates(hv), expected));
+		HvFree(hv);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Dracula is always one of the candidates\n");
+		
+		playRandomGames(checkCandidates);
+		
+		printf("Test passed!\n");
+	}
+	
+	{///////////////////////////////////////////////////////////////////
+	
+		printf("Dracula's probabilities are a distribution over the "
+		       "candidates, and capture chances are chances\n");
+		
+		playRandomGames(checkProbabilities);
+		
+		printf("Test passed!\n");
+	}
+	
+	freePastPlays(pastPlays, numPastPlays);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Asserts that two views know the same things about Dracula
+ */
+static void assertSameBeliefs(HunterView hv, HunterView expected) {
+	assert(HvGetRound(hv) == HvGetRound(expected));
+	assert(HvGetPlayer(hv) == HvGetPlayer(expected));
+	
+	Round round = -1, expectedRound = -1;
+	assert(HvGetLastKnownDraculaLocation(hv, &round) ==
+	       HvGetLastKnownDraculaLocation(expected, &expectedRound));
+	assert(round == expectedRound);
+	
+	assert(placeSetEquals(HvGetDraculaCandidates(hv),
+	                      HvGetDraculaCandidates(expected)));
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		assert(HvGetDraculaProbability(hv, p) ==
+		       HvGetDraculaProbability(expected, p));
+	}
+}
+
+/**
+ * Plays NUM_RANDOM_GAMES games with random moves, and calls `check` on
+ * each hunter's turn with the view they would be given and where
+ * Dracula really is (NOWHERE before his first move)
+ */
+static void playRandomGames(void (*check)(HunterView hv, PlaceId dracula)) {
+	static char pastPlays[MATCH_PLAYS_SIZE];
+	for (int game = 0; game < NUM_RANDOM_GAMES; game++) {
+		Match m = MatchNew();
+		Rng rng = rngNew(game);
+		while (!MatchIsOver(m)) {
+			Player player = MatchGetPlayer(m);
+			if (player != PLAYER_DRACULA) {
+				GameView gv = GvNew(MatchGetPlays(m), NULL);
+				PlaceId dracula = GvGetPlayerLocation(gv, PLAYER_DRACULA);
+				GvFree(gv);
+				
+				MatchGetPastPlays(m, player, pastPlays);
+				HunterView hv = HvNew(pastPlays, NULL);
+				check(hv, dracula);
+				HvFree(hv);
+			}
+			MatchPlay(m, randomMove(m, &rng));
+		}
+		MatchFree(m);
+	}
+}
+
+/**
+ * Picks a random legal move for the current player
+ */
+static PlaceId randomMove(Match m, Rng *rng) {
+	PlaceId moves[NUM_REAL_PLACES];
+	int numMoves = 0;
+	if (MatchGetPlayer(m) == PLAYER_DRACULA) {
+		DraculaView dv = DvNew(MatchGetPlays(m), NULL);
+		DvGetValidMovesInto(dv, moves, &numMoves);
+		DvFree(dv);
+	} else {
+		GameView gv = GvNew(MatchGetPlays(m), NULL);
+		Player player = GvGetPlayer(gv);
+		PlaceId from = GvGetPlayerLocation(gv, player);
+		if (from == NOWHERE) {
+			moves[numMoves++] = MIN_REAL_PLACE + rngBelow(rng, NUM_REAL_PLACES);
+		} else {
+			GvGetReachableInto(gv, player, GvGetRound(gv), from, moves,
+			                   &numMoves);
+		}
+		GvFree(gv);
+	}
+	
+	// NOWHERE lets Match pick the move Dracula has to make
+	return numMoves > 0 ? moves[rngBelow(rng, numMoves)] : NOWHERE;
+}
+
+static void checkCandidates(HunterView hv, PlaceId dracula) {
+	PlaceSet candidates = HvGetDraculaCandidates(hv);
+	assert(!placeSetIsEmpty(candidates));
+	assert(HvGetNumDraculaCandidates(hv) == placeSetSize(candidates));
+	if (dracula == NOWHERE) {
+		assert(!placeSetContains(candidates, HOSPITAL_PLACE));
+	} else {
+		assert(placeSetContains(candidates, dracula));
+	}
+}
+
+static void checkProbabilities(HunterView hv, PlaceId dracula) {
+	PlaceSet candidates = HvGetDraculaCandidates(hv);
+	float probs[NUM_REAL_PLACES];
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		probs[p] = HvGetDraculaProbability(hv, p);
+		assert(placeSetContains(candidates, p) ? probs[p] > 0 : probs[p] == 0);
+	}
+	assertDistribution(probs);
+	if (dracula != NOWHERE) assert(probs[dracula] > 0);
+	
+	HvGetDraculaNextProbabilities(hv, probs);
+	assertDistribution(probs);
+	
+	// Being there now and being caught on the move after don't overlap
+	Player hunter = HvGetPlayer(hv);
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		float chance = HvGetCaptureChance(hv, hunter, p);
+		assert(chance >= HvGetDraculaProbability(hv, p) - 1e-6);
+		assert(chance >= 0 && chance <= 1);
+	}
+}
+
+/**
+ * Asserts that the chances of being at each place add up to 1
+ */
+static void assertDistribution(float probs[static NUM_REAL_PLACES]) {
+	double total = 0;
+	for (PlaceId p = MIN_REAL_PLACE; p <= MAX_REAL_PLACE; p++) {
+		assert(probs[p] >= 0 && probs[p] <= 1);
+		total += probs[p];
+	}
+	assert(fabs(total - 1) < 1e-4);
+}
@@ -0,0 +1,186 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// testPlays.c: test the pastPlays parser in Plays.c
+//
+// The same tests are linked with Plays.c built for each of its paths
+// (see the Makefile), and check what TurnBufferParse decodes against
+// the plays decoded one character at a time. Every prefix of the game
+// in TEST_GAME_LOG is parsed, so every number of plays left over after
+// the last whole block is covered. The abbreviation table the parser
+// decodes moves with is checked against placeAbbrevToId.
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Game.h"
+#include "MapData.h"
+#include "Places.h"
+#include "Plays.h"
+#include "testUtils.h"
+
+static void assertParsed(TurnBuffer *buf, char *pastPlays);
+static void assertRejected(TurnBuffer *buf, char *pastPlays);
+
+int main(void)
+{
+	printf("Parsing with the %s parser\n", TurnBufferParser());
+#if defined(__x86_64__) || defined(__i386__)
+	if (strcmp(TurnBufferParser(), "AVX2") == 0 &&
+	    !__builtin_cpu_supports("avx2")) {
+		printf("This CPU doesn't have AVX2, so there is nothing to test\n");
+		return EXIT_SUCCESS;
+	}
+#endif
+
+	int numPastPlays = 0;
+	char **pastPlays = readPastPlays(TEST_GAME_LOG, &numPastPlays);
+	assert(numPastPlays > 0);
+
+	{///////////////////////////////////////////////////////////////////
+
+		printf("Parsing every string in the log\n");
+
+		TurnBuffer buf;
+		TurnBufferInit(&buf);
+		assertParsed(&buf, "");
+		for (int i = 0; i < numPastPlays; i++) {
+			assertParsed(&buf, pastPlays[i]);
+		}
+		TurnBufferFree(&buf);
+
+		printf("Test passed!\n");
+	}
+
+	{///////////////////////////////////////////////////////////////////
+
+		printf("Parsing every prefix of the game\n");
+
+		// Longest first, so the buffer never has to grow
+		char *game = strdup(pastPlays[numPastPlays - 1]);
+		assert(game != NULL);
+		int numTurns = (strlen(game) + 1) / PLAY_SIZE;
+		TurnBuffer buf;
+		TurnBufferInit(&buf);
+		for (int n = numTurns; n > 0; n--) {
+			game[n * PLAY_SIZE - 1] = '\0';
+			assertParsed(&buf, game);
+		}
+		TurnBufferFree(&buf);
+		free(game);
+
+		printf("Test passed!\n");
+	}
+
+	{///////////////////////////////////////////////////////////////////
+
+		printf("Rejecting malformed strings\n");
+
+		// Long enough for whole blocks and some plays after them. 'x' is
+		// wrong in any position of a play
+		TurnBuffer buf;
+		TurnBufferInit(&buf);
+		char plays[13 * PLAY_SIZE];
+		strncpy(plays, pastPlays[numPastPlays - 1], sizeof(plays) - 1);
+		plays[sizeof(plays) - 1] = '\0';
+		assertParsed(&buf, plays);
+		for (int i = 0; i < (int) sizeof(plays) - 1; i++) {
+			char c = plays[i];
+			plays[i] = 'x';
+			assertRejected(&buf, plays);
+			plays[i] = c;
+		}
+
+		// Encounters the player can't have, and moves they can't make
+		for (int turn = 0; turn < 13; turn++) {
+			Player player = turn % NUM_PLAYERS;
+			char *play = &plays[turn * PLAY_SIZE];
+			char saved[PLAY_SIZE - 1];
+			memcpy(saved, play, sizeof(saved));
+
+			play[3 + turn % PLAY_NUM_ENCOUNTERS] =
+				(player == PLAYER_DRACULA ? 'D' : 'M');
+			assertRejected(&buf, plays);
+			memcpy(play, saved, sizeof(saved));
+
+			memcpy(&play[1], player == PLAYER_DRACULA ? "QQ" : "HI", 2);
+			assertRejected(&buf, plays);
+			memcpy(play, saved, sizeof(saved));
+		}
+		assertParsed(&buf, plays);
+
+		// Plays cut short, run on, or without a space between them
+		char last = plays[sizeof(plays) - 2];
+		plays[sizeof(plays) - 2] = '\0';
+		assertRejected(&buf, plays);
+		plays[sizeof(plays) - 2] = last;
+		char *longer = malloc(sizeof(plays) + 1);
+		assert(longer != NULL);
+		sprintf(longer, "%s ", plays);
+		assertRejected(&buf, longer);
+		free(longer);
+		plays[6 * PLAY_SIZE - 1] = '.';
+		assertRejected(&buf, plays);
+
+		TurnBufferFree(&buf);
+
+		printf("Test passed!\n");
+	}
+
+	{///////////////////////////////////////////////////////////////////
+
+		printf("Decoding every pair of characters\n");
+
+		// The table only looks at 6 bits of each, so anything but an
+		// abbreviation must still come out as NOWHERE
+		for (int c0 = 1; c0 < 256; c0++) {
+			for (int c1 = 0; c1 < 256; c1++) {
+				char abbrev[3] = { (char) c0, (char) c1, '\0' };
+				assert(mapAbbrevToId(abbrev) == placeAbbrevToId(abbrev));
+			}
+		}
+
+		printf("Test passed!\n");
+	}
+
+	freePastPlays(pastPlays, numPastPlays);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Asserts that a well-formed string parses into the plays it has
+ */
+static void assertParsed(TurnBuffer *buf, char *pastPlays) {
+	assert(TurnBufferParse(buf, pastPlays));
+	int numTurns = (strlen(pastPlays) + 1) / PLAY_SIZE;
+	assert(buf->numTurns == numTurns);
+
+	for (int i = 0; i < numTurns; i++) {
+		char *play = &pastPlays[i * PLAY_SIZE];
+		assert(buf->players[i] == i % NUM_PLAYERS);
+		assert(buf->moves[i] == mapAbbrevToId(&play[1]));
+		for (int j = 0; j < PLAY_NUM_ENCOUNTERS; j++) {
+			EncounterCode code = ENCOUNTER_NONE;
+			switch (play[3 + j]) {
+				case 'T': code = ENCOUNTER_TRAP;    break;
+				case 'V': code = ENCOUNTER_VAMPIRE; break;
+				case 'D': code = ENCOUNTER_OTHER;   break;
+				case 'M': code = ENCOUNTER_OTHER;   break;
+				default:  assert(play[3 + j] == '.'); break;
+			}
+			assert(playEncounter(buf->encounters[i], j) == code);
+		}
+	}
+}
+
+/**
+ * Asserts that a string doesn't parse, and leaves the buffer empty
+ */
+static void assertRejected(TurnBuffer *buf, char *pastPlays) {
+	assert(!TurnBufferParse(buf, pastPlays));
+	assert(buf->numTurns == 0);
+}
@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// testUtils.c: test utilities
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "testUtils.h"
+
+#define PAST_PLAYS_KEY "\"past_plays\": \""
+
+char **readPastPlays(char *path, int *numPastPlays) {
+	FILE *in = fopen(path, "r");
+	if (in == NULL) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	
+	char **pastPlays = NULL;
+	int n = 0;
+	char *line = NULL;
+	size_t size = 0;
+	while (getline(&line, &size, in) != -1) {
+		char *start = strstr(line, PAST_PLAYS_KEY);
+		if (start == NULL) continue;
+		start += strlen(PAST_PLAYS_KEY);
+		char *end = strchr(start, '"');
+		if (end == NULL) continue;
+		
+		char **grown = realloc(pastPlays, (n + 1) * sizeof(char *));
+		if (grown == NULL) {
+			fprintf(stderr, "Couldn't allocate pastPlays!\n");
+			freePastPlays(pastPlays, n);
+			exit(EXIT_FAILURE);
+		}
+		pastPlays = grown;
+		
+		pastPlays[n] = strndup(start, end - start);
+		if (pastPlays[n] == NULL) {
+			fprintf(stderr, "Couldn't allocate pastPlays!\n");
+			freePastPlays(pastPlays, n);
+			exit(EXIT_FAILURE);
+		}
+		n++;
+	}
+	
+	free(line);
+	fclose(in);
+	*numPastPlays = n;
+	return pastPlays;
+}
+
+void freePastPlays(char **pastPlays, int numPastPlays) {
+	for (int i = 0; i < numPastPlays; i++) {
+		free(pastPlays[i]);
+	}
+	free(pastPlays);
+}
+
+bool sameState(GameState *s1, GameState *s2) {
+	if (s1->hash != s2->hash || s1->round != s2->round ||
+	    s1->score != s2->score || s1->player != s2->player ||
+	    s1->trailLength != s2->trailLength ||
+	    s1->numTraps != s2->numTraps || s1->vampire != s2->vampire) {
+		return false;
+	}
+	
+	for (int i = 0; i < NUM_PLAYERS; i++) {
+		if (s1->health[i] != s2->health[i] ||
+		    s1->location[i] != s2->location[i]) {
+			return false;
+		}
+	}
+	for (int i = 0; i < s1->trailLength; i++) {
+		if (s1->trailMoves[i] != s2->trailMoves[i] ||
+		    s1->trailLocations[i] != s2->trailLocations[i]) {
+			return false;
+		}
+	}
+	
+	// Traps are in no particular order
+	int matched[TRAIL_SIZE] = { 0 };
+	for (int i = 0; i < s1->numTraps; i++) {
+		int j = 0;
+		while (j < s2->numTraps &&
+		       (matched[j] || s2->traps[j] != s1->traps[i])) {
+			j++;
+		}
+		if (j == s2->numTraps) return false;
+		matched[j] = 1;
+	}
+	return true;
+}
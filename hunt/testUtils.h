@@ -0,0 +1,37 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// testUtils.h: test utilities
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "Game.h"
+#include "GameView.h"
+#include "Places.h"
+
+#ifndef FOD__TEST_UTILS_H_
+#define FOD__TEST_UTILS_H_
+
+// The game engine's log of a whole game, with the pastPlays string for
+// every turn our AIs played
+#define TEST_GAME_LOG "output.txt"
+
+/**
+ * Reads every pastPlays string (each "past_plays": "...") in the given
+ * game engine log into a newly allocated array, and sets *numPastPlays
+ * to how many there were. Free it with freePastPlays.
+ */
+char **readPastPlays(char *path, int *numPastPlays);
+
+/** Frees an array returned by readPastPlays. */
+void freePastPlays(char **pastPlays, int numPastPlays);
+
+/**
+ * Checks whether two game states are the same, field by field (so the
+ * padding in between doesn't matter).
+ */
+bool sameState(GameState *s1, GameState *s2);
+
+#endif // !defined (FOD__TEST_UTILS_H_)
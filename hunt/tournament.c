@@ -0,0 +1,329 @@
+////////////////////////////////////////////////////////////////////////
+// COMP2521 20T2 ... the Fury of Dracula
+// tournament.c: plays many games at once, to compare hunter AIs
+//
+// Every hunter AI given plays the same games (the same seeds) against
+// dracula.c, and the results are added up for each: how often Dracula
+// was killed, the average score and length of a game, and how long the
+// turns took. The older hunter AIs are built with decideHunterMove
+// renamed (see the Makefile), so they can all be linked in at once.
+//
+// Each game runs in its own child process, on a Match (see Match.h),
+// with the AIs deciding in the same process - so an AI that crashes
+// only loses that game, which is counted. Turns aren't cut off at the
+// time limit, but turns that go over it are counted.
+//
+// Unless they are set already, the AIs are given FOD_THREADS=1 (the
+// games run in parallel instead), FOD_SEARCH_DEPTH=2 and
+// FOD_MCTS_ITERATIONS=2000, so the games are quick and the same seed
+// always gives the same game. Set them to play stronger AIs.
+//
+// Usage: ./tournament [-n games] [-j jobs] [-s seed] [-h hunters] [-v]
+//   -n  the number of games for each hunter AI (default 100)
+//   -j  the number of games to play at once (default one per core)
+//   -s  the seed for the first game; game i uses seed + i (default 0),
+//       which the AIs are given as FOD_SEED (see Rng.h)
+//   -h  the hunter AIs to play, separated by commas (default all of
+//       hunter, previoushunter, notasoldhunter and oldhunter)
+//   -v  print the result of each game
+//
+////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dracula.h"
+#include "DraculaView.h"
+#include "Game.h"
+#include "hunter.h"
+#include "HunterView.h"
+#include "Match.h"
+#include "Places.h"
+
+// Moves given by registerBestPlay are this long (including terminator)
+#define MOVE_SIZE 3
+#define MAX_JOBS 256
+
+// The older hunter AIs
+void decidePreviousHunterMove(HunterView hv);
+void decideNotAsOldHunterMove(HunterView hv);
+void decideOldHunterMove(HunterView hv);
+
+typedef struct hunterAi {
+	char *name;
+	void (*decideMove)(HunterView hv);
+} HunterAi;
+
+static HunterAi HUNTER_AIS[] = {
+	{ "hunter",         decideHunterMove },
+	{ "previoushunter", decidePreviousHunterMove },
+	{ "notasoldhunter", decideNotAsOldHunterMove },
+	{ "oldhunter",      decideOldHunterMove },
+};
+#define NUM_HUNTER_AIS ((int) (sizeof(HUNTER_AIS) / sizeof(HUNTER_AIS[0])))
+
+// The hunters' side and Dracula's side, for the statistics
+enum { HUNTERS, DRACULA, NUM_SIDES };
+
+// What a child process sends back about its game
+typedef struct result {
+	int ai;                          // index into HUNTER_AIS
+	int game;
+	int score;
+	int rounds;
+	bool draculaKilled;
+	int numTurns[NUM_SIDES];
+	int numBadMoves[NUM_SIDES];
+	int numSlowTurns[NUM_SIDES];     // over TURN_LIMIT_MSECS
+	long totalUsecs[NUM_SIDES];
+	long maxUsecs[NUM_SIDES];
+} Result;
+
+// The results of every game for one hunter AI
+typedef struct totals {
+	int numGames;                    // started
+	int numFinished;                 // the rest crashed
+	int numKills;
+	long totalScore;
+	long totalRounds;
+	Result turns;                    // turn statistics, added up
+} Totals;
+
+static char latestPlay[MOVE_SIZE] = "";
+
+static void playGame(int ai, int game, unsigned seed, Result *r);
+static void addResult(Totals *t, Result *r);
+static void printTotals(char *name, Totals *t);
+static long usecsSince(struct timespec *start);
+
+int main(int argc, char *argv[])
+{
+	int numGames = 100;
+	long numJobs = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned seed = 0;
+	char *hunters = NULL;
+	bool verbose = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "n:j:s:h:v")) != -1) {
+		switch (opt) {
+			case 'n': numGames = atoi(optarg); break;
+			case 'j': numJobs = atol(optarg); break;
+			case 's': seed = strtoul(optarg, NULL, 10); break;
+			case 'h': hunters = optarg; break;
+			case 'v': verbose = true; break;
+			default:
+				fprintf(stderr, "usage: %s [-n games] [-j jobs] [-s seed] "
+				        "[-h hunters] [-v]\n", argv[0]);
+				return EXIT_FAILURE;
+		}
+	}
+	if (numJobs < 1) numJobs = 1;
+	if (numJobs > MAX_JOBS) numJobs = MAX_JOBS;
+
+	// Which hunter AIs to play
+	bool playing[NUM_HUNTER_AIS];
+	for (int ai = 0; ai < NUM_HUNTER_AIS; ai++) {
+		playing[ai] = (hunters == NULL);
+	}
+	for (char *name = hunters ? strtok(hunters, ",") : NULL; name != NULL;
+	     name = strtok(NULL, ",")) {
+		int ai = 0;
+		while (ai < NUM_HUNTER_AIS && strcmp(HUNTER_AIS[ai].name, name) != 0) ai++;
+		if (ai == NUM_HUNTER_AIS) {
+			fprintf(stderr, "%s: no hunter AI called '%s'\n", argv[0], name);
+			return EXIT_FAILURE;
+		}
+		playing[ai] = true;
+	}
+
+	setenv("FOD_THREADS", "1", 0);
+	setenv("FOD_SEARCH_DEPTH", "2", 0);
+	setenv("FOD_MCTS_ITERATIONS", "2000", 0);
+
+	// Every child writes its result to the same pipe; they're small
+	// enough that the writes never get mixed up
+	int fds[2];
+	if (pipe(fds) != 0) {
+		perror("pipe");
+		exit(EXIT_FAILURE);
+	}
+	fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	Totals totals[NUM_HUNTER_AIS] = { { 0 } };
+	int numRunning = 0;
+	int next = 0;                    // the next game, over all the AIs
+	while (true) {
+		// Skip the AIs that aren't playing
+		while (next < NUM_HUNTER_AIS * numGames && !playing[next / numGames]) {
+			next += numGames;
+		}
+
+		if (next < NUM_HUNTER_AIS * numGames && numRunning < numJobs) {
+			int ai = next / numGames;
+			int game = next % numGames;
+			next++;
+			fflush(stdout);
+			pid_t pid = fork();
+			if (pid < 0) {
+				perror("fork");
+				exit(EXIT_FAILURE);
+			}
+			if (pid == 0) {
+				close(fds[0]);
+				Result r;
+				playGame(ai, game, seed + game, &r);
+				if (write(fds[1], &r, sizeof(r)) != sizeof(r)) {
+					_exit(EXIT_FAILURE);
+				}
+				_exit(EXIT_SUCCESS);
+			}
+			totals[ai].numGames++;
+			numRunning++;
+			continue;
+		}
+		if (numRunning == 0) break;
+
+		int status;
+		if (wait(&status) < 0) {
+			if (errno == EINTR) continue;
+			perror("wait");
+			exit(EXIT_FAILURE);
+		}
+		numRunning--;
+
+		Result r;
+		while (read(fds[0], &r, sizeof(r)) == sizeof(r)) {
+			addResult(&totals[r.ai], &r);
+			if (verbose) {
+				printf("%s game %d (seed %u): %s, score %d, round %d\n",
+				       HUNTER_AIS[r.ai].name, r.game, seed + r.game,
+				       r.draculaKilled ? "hunters won" : "Dracula won",
+				       r.score, r.rounds);
+			}
+		}
+	}
+	close(fds[0]);
+	close(fds[1]);
+
+	long usecs = usecsSince(&start);
+	printf("%-15s %6s %7s %7s %7s %7s %9s %9s %6s %9s %9s %6s %5s\n",
+	       "hunter AI", "games", "crashes", "killed", "score", "rounds",
+	       "hunter", "max", "slow", "Dracula", "max", "slow", "bad");
+	for (int ai = 0; ai < NUM_HUNTER_AIS; ai++) {
+		if (playing[ai]) printTotals(HUNTER_AIS[ai].name, &totals[ai]);
+	}
+	printf("(turn times are the average and slowest in ms; %.1fs in all)\n",
+	       usecs / 1e6);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * Plays one game between the given hunter AI and dracula.c, and fills
+ * in *r
+ */
+static void playGame(int ai, int game, unsigned seed, Result *r)
+{
+	memset(r, 0, sizeof(*r));
+	r->ai = ai;
+	r->game = game;
+
+	// The AIs work out a seed for each turn from this
+	char gameSeed[32];
+	snprintf(gameSeed, sizeof(gameSeed), "%u", seed);
+	setenv("FOD_SEED", gameSeed, 1);
+
+	static char pastPlays[MATCH_PLAYS_SIZE];
+	Match m = MatchNew();
+	while (!MatchIsOver(m)) {
+		Player player = MatchGetPlayer(m);
+		int side = (player == PLAYER_DRACULA ? DRACULA : HUNTERS);
+		MatchGetPastPlays(m, player, pastPlays);
+		latestPlay[0] = '\0';
+
+		struct timespec start;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (player == PLAYER_DRACULA) {
+			DraculaView dv = DvNew(pastPlays, NULL);
+			decideDraculaMove(dv);
+			DvFree(dv);
+		} else {
+			HunterView hv = HvNew(pastPlays, NULL);
+			HUNTER_AIS[ai].decideMove(hv);
+			HvFree(hv);
+		}
+		long usecs = usecsSince(&start);
+
+		r->numTurns[side]++;
+		r->totalUsecs[side] += usecs;
+		if (usecs > r->maxUsecs[side]) r->maxUsecs[side] = usecs;
+		if (usecs > TURN_LIMIT_MSECS * 1000L) r->numSlowTurns[side]++;
+
+		PlaceId move = latestPlay[0] == '\0' ? NOWHERE : placeAbbrevToId(latestPlay);
+		if (!MatchPlay(m, move)) r->numBadMoves[side]++;
+	}
+
+	r->score = MatchGetScore(m);
+	r->rounds = MatchGetRound(m);
+	r->draculaKilled = MatchGetHealth(m, PLAYER_DRACULA) <= 0;
+	MatchFree(m);
+}
+
+void registerBestPlay(char *play, Message message)
+{
+	strncpy(latestPlay, play, MOVE_SIZE - 1);
+	latestPlay[MOVE_SIZE - 1] = '\0';
+}
+
+static void addResult(Totals *t, Result *r)
+{
+	t->numKills += r->draculaKilled;
+	t->totalScore += r->score;
+	t->totalRounds += r->rounds;
+	for (int side = 0; side < NUM_SIDES; side++) {
+		t->turns.numTurns[side] += r->numTurns[side];
+		t->turns.numBadMoves[side] += r->numBadMoves[side];
+		t->turns.numSlowTurns[side] += r->numSlowTurns[side];
+		t->turns.totalUsecs[side] += r->totalUsecs[side];
+		if (r->maxUsecs[side] > t->turns.maxUsecs[side])
+			t->turns.maxUsecs[side] = r->maxUsecs[side];
+	}
+	t->numFinished++;
+}
+
+static void printTotals(char *name, Totals *t)
+{
+	double n = t->numFinished > 0 ? t->numFinished : 1;
+	double avgUsecs[NUM_SIDES];
+	for (int side = 0; side < NUM_SIDES; side++) {
+		int turns = t->turns.numTurns[side];
+		avgUsecs[side] = turns > 0 ? (double) t->turns.totalUsecs[side] / turns : 0;
+	}
+
+	printf("%-15s %6d %7d %6.1f%% %7.1f %7.1f %9.2f %9.1f %6d %9.2f %9.1f %6d %5d\n",
+	       name, t->numGames, t->numGames - t->numFinished, 100 * t->numKills / n,
+	       t->totalScore / n, t->totalRounds / n,
+	       avgUsecs[HUNTERS] / 1000, t->turns.maxUsecs[HUNTERS] / 1000.0,
+	       t->turns.numSlowTurns[HUNTERS],
+	       avgUsecs[DRACULA] / 1000, t->turns.maxUsecs[DRACULA] / 1000.0,
+	       t->turns.numSlowTurns[DRACULA],
+	       t->turns.numBadMoves[HUNTERS] + t->turns.numBadMoves[DRACULA]);
+}
+
+static long usecsSince(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1000000 +
+	       (now.tv_nsec - start->tv_nsec) / 1000;
+}